@@ -79,24 +79,373 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <avr/io.h>
+#include <avr/sleep.h>
 #include <avr/interrupt.h>
 
 #include <string.h>
 
 #include "PortMacros.h"
 #include "AtoD.h"
+#include "AtoDShare.h"
+#include "Profile.h"
+
+#ifdef POST_AtoDEvent
+#include "Event.h"
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static struct {
+static volatile struct {
     uint8_t     CurrentChannel;                 // Current conversion
     uint16_t    Channels[NUM_ATOD];             // Value of conversions
+#ifdef ATOD_OVERSAMPLE
+    uint16_t    Accum;                          // Sum of current channel samples
+    uint8_t     Remaining;                      // Samples left for current channel
+#endif
+#ifdef ATOD_FILTER
+    uint16_t    Filtered[NUM_ATOD];             // Filter outputs
+    uint32_t    FilterSum[NUM_ATOD];            // EMA or boxcar running sum
+    uint16_t    History[NUM_ATOD][ATOD_HISTORY];// Boxcar and median samples
+    uint8_t     HistIdx[NUM_ATOD];              // Oldest boxcar sample
+    bool        Primed[NUM_ATOD];               // TRUE once first sample seen
+#endif
+#ifdef AUTO_TRIGGER_AtoD
+    uint16_t    FIFO[NUM_ATOD][ATOD_FIFO_SIZE]; // Samples, per channel
+    uint8_t     FIFO_In [NUM_ATOD];             // FIFO input  pointers
+    uint8_t     FIFO_Out[NUM_ATOD];             // FIFO output pointers
+    uint16_t    Dropped [NUM_ATOD];             // Samples dropped, FIFO full
+#endif
+#ifdef ATOD_SEQUENCE
+    uint8_t     RepeatLeft;                     // Readings left for current entry
+    uint8_t     Skip[NUM_ATOD];                 // Scans until entry is due
+#endif
+#ifdef ATOD_SHARED
+    uint8_t     Handle;                         // AtoDShare client of channel 0
+#else
+    bool        Discard;                        // Next conversion is ref settling
+#endif
     } AtoD NOINIT;
 
+#ifdef ATOD_NOISE_REDUCTION
+#define START_ATOD                              // Started by sleeping, see AtoDSleepScan
+#else
 #define START_ATOD  { _SET_BIT(ADCSRA,ADSC); }  // Start the AtoD conversion
-#define ADMUX_VAL   (_PIN_MASK(REFS0))
-#define TEMP_CHANNEL    9
+#endif
+//
+// Sequence entry settings. Without ATOD_SEQUENCE entry n is input n, and the
+//   temp sensor (entry 8) uses the internal 1.1v ref.
+//
+#ifdef ATOD_SEQUENCE
+static const ATOD_SEQ_T Sequence[NUM_ATOD] = ATOD_SEQUENCE;
+
+#define SEQ_MUX(_ch_)       (Sequence[_ch_].Mux)
+#define SEQ_REF(_ch_)       (Sequence[_ch_].Ref)
+#define SEQ_REPEAT(_ch_)    (Sequence[_ch_].Repeat ? Sequence[_ch_].Repeat : 1)
+#define SEQ_SKIP(_ch_)      (Sequence[_ch_].Every  ? Sequence[_ch_].Every-1 : 0)
+
+#define NEXT_ENTRY(_ch_)    AtoDNextEntry(_ch_)
+#define LAST_REPEAT         (--AtoD.RepeatLeft == 0)
+
+static uint8_t AtoDNextEntry(uint8_t Channel);
+#else
+#define SEQ_MUX(_ch_)       ATOD_ADC(_ch_)
+#ifdef ATOD_TEMP
+#define SEQ_REF(_ch_)       ((_ch_) == ATOD_TEMP ? ATOD_REF_1V1 : ATOD_REF_AVCC)
+#else
+#define SEQ_REF(_ch_)       ATOD_REF_AVCC
+#endif
+
+#define NEXT_ENTRY(_ch_)    (_ch_)
+#define LAST_REPEAT         true
+#endif
+
+#define ATOD_MUX(_ch_)      (SEQ_REF(_ch_) | (SEQ_MUX(_ch_) & 0x1F))
+
+#ifdef ATOD_SHARED
+#if defined(AUTO_TRIGGER_AtoD) || defined(ATOD_NOISE_REDUCTION)
+#error "AtoD: ATOD_SHARED only works in command mode"
+#endif
+
+#define CONVERT_ATOD(_ch_)  AtoDShareRequest(AtoD.Handle+(_ch_))
+#else
+#define CONVERT_ATOD(_ch_)  { AtoDSelect(_ch_); START_ATOD; }
+
+static void AtoDSelect(uint8_t Channel);
+#endif
+
+#ifdef ATOD_OVERSAMPLE
+static const uint8_t Oversample[NUM_ATOD] = ATOD_OVERSAMPLE;  // Extra bits, per channel
+
+#define OVERSAMPLE_COUNT(_ch_)  (1 << (2*Oversample[_ch_]))    // == 4^n samples
+#endif
+
+#ifdef ATOD_FILTER
+static const uint8_t Filter[NUM_ATOD] = ATOD_FILTER;        // Filter type, per channel
+
+#define FILTER_TYPE(_f_)        ((_f_) & 0xF0)
+#define FILTER_SHIFT(_f_)       ((_f_) & 0x0F)
+#endif
+
+#ifdef ATOD_NOISE_REDUCTION
+#if defined(AUTO_TRIGGER_AtoD) || defined(ContinuousAtoD)
+#error "AtoD: ATOD_NOISE_REDUCTION only works in command mode"
+#endif
+
+static void AtoDSleepScan(void);
+#endif
+
+#ifdef AUTO_TRIGGER_AtoD
+#define FIFO_WRAP   (ATOD_FIFO_SIZE-1)
+
+//
+// Timer0 runs in CTC mode, and compare match A triggers each conversion. Pick
+//   the smallest prescaler giving an exact sample rate that fits in 8 bits.
+//
+#define _ATOD_FITS(_p_) ((F_CPU % ((_p_)*ATOD_SAMPLE_HZ)) == 0 && F_CPU/((_p_)*ATOD_SAMPLE_HZ) <= 256)
+
+#if   _ATOD_FITS(8UL)
+#define ATOD_TIMER_PRESCALE 8UL
+#define ATOD_TIMER_CLOCK    _PIN_MASK(CS01)
+#elif _ATOD_FITS(64UL)
+#define ATOD_TIMER_PRESCALE 64UL
+#define ATOD_TIMER_CLOCK    (_PIN_MASK(CS01) | _PIN_MASK(CS00))
+#elif _ATOD_FITS(256UL)
+#define ATOD_TIMER_PRESCALE 256UL
+#define ATOD_TIMER_CLOCK    _PIN_MASK(CS02)
+#elif _ATOD_FITS(1024UL)
+#define ATOD_TIMER_PRESCALE 1024UL
+#define ATOD_TIMER_CLOCK    (_PIN_MASK(CS02) | _PIN_MASK(CS00))
+#else
+#error "AtoD: no Timer0 prescaler gives an exact ATOD_SAMPLE_HZ"
+#endif
+
+//
+// ADC clock is F_CPU/128, and an auto triggered conversion takes 13.5 ADC clocks
+//
+#if ATOD_SAMPLE_HZ*27UL > (F_CPU/128)*2
+#error "AtoD: ATOD_SAMPLE_HZ is faster than the ADC can convert"
+#endif
+
+#define ATOD_TRIGGER    (_PIN_MASK(ADTS1) | _PIN_MASK(ADTS0))   // Timer0 compare match A
+#endif
     
+#ifdef ATOD_OVERSAMPLE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDDecimate - Return oversampled result of current channel
+//
+// The sum of 4^n samples, shifted right by n (with rounding) gives n extra bits
+//   of resolution. Also resets the sum for the next channel.
+//
+static inline uint16_t AtoDDecimate(uint8_t Channel) {
+    uint8_t  Bits   = Oversample[Channel];
+    uint16_t Rtnval = (AtoD.Accum + ((1 << Bits) >> 1)) >> Bits;
+
+    AtoD.Accum = 0;
+    return Rtnval;
+    }
+#endif
+
+#ifdef ATOD_FILTER
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDFilter - Run one sample through the channel filter
+//
+// Each filter does a constant amount of work per sample, no matter how long
+//   its window. The first sample seen fills the filter history, so the output
+//   starts at the input level instead of ramping up from zero.
+//
+static inline uint16_t AtoDFilter(uint8_t Channel,uint16_t Sample) {
+    uint8_t  Shift = FILTER_SHIFT(Filter[Channel]);
+    uint16_t Oldest;
+    uint16_t Prev;
+
+    if( !AtoD.Primed[Channel] ) {
+        for( uint8_t i=0; i<ATOD_HISTORY; i++ )
+            AtoD.History[Channel][i] = Sample;
+        AtoD.FilterSum[Channel] = (uint32_t) Sample << Shift;
+        AtoD.Primed[Channel]    = true;
+        }
+
+    switch( FILTER_TYPE(Filter[Channel]) ) {
+
+        //
+        // Sum holds y*2^k, so y += (x-y)/2^k becomes Sum += x - Sum/2^k
+        //
+        case ATOD_FILTER_EMA:
+            AtoD.FilterSum[Channel] += Sample - (AtoD.FilterSum[Channel] >> Shift);
+            return AtoD.FilterSum[Channel] >> Shift;
+
+        //
+        // Sum holds the last 2^n samples: add the newest, drop the oldest
+        //
+        case ATOD_FILTER_BOXCAR:
+            Oldest = AtoD.History[Channel][AtoD.HistIdx[Channel]];
+            AtoD.History[Channel][AtoD.HistIdx[Channel]] = Sample;
+            AtoD.HistIdx[Channel] = (AtoD.HistIdx[Channel]+1) & ((1 << Shift)-1);
+            AtoD.FilterSum[Channel] += Sample - Oldest;
+            return AtoD.FilterSum[Channel] >> Shift;
+
+        //
+        // Middle value of the last 3 samples, rejects single sample spikes
+        //
+        case ATOD_FILTER_MEDIAN3:
+            Oldest = AtoD.History[Channel][0];
+            Prev   = AtoD.History[Channel][1];
+            AtoD.History[Channel][0] = Prev;
+            AtoD.History[Channel][1] = Sample;
+
+            if( Oldest > Prev ) { uint16_t Temp = Oldest; Oldest = Prev; Prev = Temp; }
+            if( Sample >= Prev   ) return Prev;
+            if( Sample <= Oldest ) return Oldest;
+            return Sample;
+
+        default:
+            return Sample;
+        }
+    }
+#endif
+
+#ifndef ATOD_SHARED
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDSelect - Set the mux and reference for a sequence entry
+//
+// The reference takes time to settle after a change, so the next conversion
+//   is marked to be thrown away.
+//
+static void AtoDSelect(uint8_t Channel) {
+    uint8_t Mux = ATOD_MUX(Channel);
+
+    if( (ADMUX ^ Mux) & ATOD_REF_MASK )
+        AtoD.Discard = true;
+
+    ADMUX = Mux;
+
+#ifdef MUX5
+    if( SEQ_MUX(Channel) & 0x20 ) { _SET_BIT(ADCSRB,MUX5); }
+    else                          { _CLR_BIT(ADCSRB,MUX5); }
+#endif
+    }
+#endif
+
+#ifdef ATOD_SEQUENCE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDNextEntry - Find the next sequence entry due in this scan
+//
+// Entries with an Every count are skipped in all but one of every Every scans.
+//
+// Inputs:      First entry to check
+//
+// Outputs:     Next entry due, or NUM_ATOD if no more this scan
+//
+static uint8_t AtoDNextEntry(uint8_t Channel) {
+
+    for( ; Channel < NUM_ATOD; Channel++ ) {
+        if( AtoD.Skip[Channel] == 0 ) {
+            AtoD.Skip[Channel] = SEQ_SKIP(Channel);
+            AtoD.RepeatLeft    = SEQ_REPEAT(Channel);
+            return Channel;
+            }
+        AtoD.Skip[Channel]--;
+        }
+
+    return NUM_ATOD;
+    }
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDFirstEntry - Find the first sequence entry of a new scan
+//
+// A scan where no entry is due is skipped, so every scan converts something.
+//
+static uint8_t AtoDFirstEntry(void) {
+    uint8_t Channel;
+
+    do {
+        Channel = NEXT_ENTRY(0);
+        } while( Channel == NUM_ATOD );
+
+    return Channel;
+    }
+
+#ifndef AUTO_TRIGGER_AtoD
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDResult - Process one conversion result in command mode
+//
+// Called from the ADC ISR, or from the AtoDShare ISR when ATOD_SHARED.
+//
+// Inputs:      Result of conversion
+//
+// Outputs:     None.
+//
+static void AtoDResult(uint16_t Sample) {
+    uint8_t Channel = AtoD.CurrentChannel;
+
+    if( Channel == NUM_ATOD )                   // Ignore spurious interrupts
+        return;
+
+#ifndef ATOD_SHARED
+    if( AtoD.Discard ) {                        // Reference settling, do it again
+        AtoD.Discard = false;
+        START_ATOD;
+        return;
+        }
+#endif
+
+    //
+    // Grab the current conversion
+    //
+#ifdef ATOD_OVERSAMPLE
+    AtoD.Accum += Sample;
+    if( --AtoD.Remaining != 0 ) {               // Same channel again
+        CONVERT_ATOD(Channel);
+        return;
+        }
+
+    Sample = AtoDDecimate(Channel);
+#endif
+
+    AtoD.Channels[Channel] = Sample;
+#ifdef ATOD_FILTER
+    AtoD.Filtered[Channel] = AtoDFilter(Channel,Sample);
+#endif
+
+    //
+    // If not complete, start the next conversion
+    //
+    if( LAST_REPEAT )
+        AtoD.CurrentChannel = NEXT_ENTRY(Channel+1);
+
+    if( AtoD.CurrentChannel < NUM_ATOD ) {
+#ifdef ATOD_OVERSAMPLE
+        AtoD.Remaining = OVERSAMPLE_COUNT(AtoD.CurrentChannel);
+#endif
+        CONVERT_ATOD(AtoD.CurrentChannel);
+        return;
+        }
+
+    //
+    // Call the user's function
+    //
+#ifdef CALL_AtoDISR
+    AtoDISR();
+#endif
+
+#ifdef POST_AtoDEvent
+    EventPost(EVENT_ATOD);
+#endif
+
+#ifdef  ContinuousAtoD
+    StartAtoD();
+#endif
+    }
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -108,8 +457,22 @@ static struct {
 //
 void AtoDInit(void) {
 
-    memset(&AtoD,0,sizeof(AtoD));
+    memset((void *) &AtoD,0,sizeof(AtoD));
 
+    AtoD.CurrentChannel = NUM_ATOD;
+
+#ifdef ATOD_SHARED
+    //
+    // One on-request client per channel, with consecutive handles
+    //
+    for( uint8_t Channel = 0; Channel < NUM_ATOD; Channel++ ) {
+        ATOD_CLIENT Client = { ATOD_MUX(Channel), ATOD_PRESCALE_128, 0, AtoDResult };
+        uint8_t     Handle = AtoDShareAdd(&Client);
+
+        if( Channel == 0 )
+            AtoD.Handle = Handle;
+        }
+#else
     //
     // Setup AtoD channels for input
     //
@@ -117,17 +480,41 @@ void AtoDInit(void) {
 
     DIDR0  = 0;                             // Turn off digital outputs
     ADCSRB = 0;                             // Free running mode
-    ADMUX  = ADMUX_VAL;                     // AVCC as ref, number of channels
+    ADMUX  = ATOD_REF_AVCC;                 // AVCC as ref
     ADCSRA = _PIN_MASK(ADPS2) | _PIN_MASK(ADPS1) | _PIN_MASK(ADPS0) |   // Prescale to 150 KHz
              _PIN_MASK(ADEN)  | _PIN_MASK(ADIE);                        // Enable, Enable int
+#endif
 
-    AtoD.CurrentChannel = NUM_ATOD;
+#ifdef AUTO_TRIGGER_AtoD
+    //
+    // Timer0 compare match starts each conversion. The ISR moves ADMUX to the
+    //   next channel before the next compare match.
+    //
+    ADCSRB  = ATOD_TRIGGER;
+
+    AtoD.CurrentChannel = AtoDFirstEntry();
+    AtoDSelect(AtoD.CurrentChannel);
+#ifdef ATOD_OVERSAMPLE
+    AtoD.Accum          = 0;
+    AtoD.Remaining      = OVERSAMPLE_COUNT(AtoD.CurrentChannel);
+#endif
+
+    _CLR_BIT(PRR,PRTIM0);                   // Powerup the trigger timer
+
+    TCCR0A = _PIN_MASK(WGM01);              // CTC mode, OCR0A as top
+    TCCR0B = ATOD_TIMER_CLOCK;
+    OCR0A  = F_CPU/(ATOD_TIMER_PRESCALE*ATOD_SAMPLE_HZ) - 1;
+    TCNT0  = 0;
+    TIFR0  = _PIN_MASK(OCF0A);              // Trigger on next compare
+
+    _SET_BIT(ADCSRA,ADATE);                 // Auto trigger enable
+#endif
 
     //
     // If user wants continuous outputs, start the conversion
     //
 #ifdef  ContinuousAtoD
-    START_ATOD;
+    StartAtoD();
 #endif
     }
 
@@ -143,16 +530,85 @@ void AtoDInit(void) {
 //
 void StartAtoD(void) { 
 
+#ifdef AUTO_TRIGGER_AtoD
+    return;                                 // Started by hardware
+#endif
+
     if( !AtoDComplete() )                   // Return if already in progress
         return;
 
-    AtoD.CurrentChannel = 0;
+    AtoD.CurrentChannel = AtoDFirstEntry();
+#ifdef ATOD_OVERSAMPLE
+    AtoD.Accum          = 0;
+    AtoD.Remaining      = OVERSAMPLE_COUNT(AtoD.CurrentChannel);
+#endif
+
+    CONVERT_ATOD(AtoD.CurrentChannel);
 
-    ADMUX = ADMUX_VAL | 0;                  // Start at channel 0
-    START_ATOD;
+#ifdef ATOD_NOISE_REDUCTION
+    AtoDSleepScan();
+#endif
     }
 
 
+#ifdef ATOD_NOISE_REDUCTION
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDSleepScan - Run the scan, sleeping in ADC noise reduction mode
+//
+// Entering SLEEP_MODE_ADC with no conversion running starts one, and the ADC
+//   ISR wakes the CPU when it's done. The ISR sets up the next channel without
+//   starting it, and the next sleep starts it.
+//
+// Other interrupts (UART, timers, etc) can wake the CPU before the conversion
+//   is done. Sleeping in ADC mode again would be a race with the conversion
+//   finishing (and starting another on the same channel), so the rest of that
+//   conversion is waited out in idle mode instead, which doesn't start one.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void AtoDSleepScan(void) {
+    uint8_t SleepMode = SMCR;               // Restore caller's mode when done
+
+    while( !AtoDComplete() ) {
+
+        //
+        // No conversion running or waiting for the ISR: start the next one
+        //
+        set_sleep_mode(SLEEP_MODE_ADC);
+        cli();
+        if( _BIT_OFF(ADCSRA,ADSC) && _BIT_OFF(ADCSRA,ADIF) && !AtoDComplete() ) {
+            sleep_enable();
+            sei();
+            sleep_cpu();
+            sleep_disable();
+            }
+        sei();
+
+        //
+        // Woken early by some other interrupt: wait for the conversion to finish
+        //
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        while( _BIT_ON(ADCSRA,ADSC) ) {
+            cli();
+            if( _BIT_ON(ADCSRA,ADSC) ) {
+                sleep_enable();
+                sei();
+                sleep_cpu();
+                sleep_disable();
+                }
+            sei();
+            }
+        }
+
+    SMCR = SleepMode;
+    }
+#endif
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -176,11 +632,91 @@ bool AtoDComplete(void) { return(AtoD.CurrentChannel == NUM_ATOD); }
 // Outputs:     Value of measured AtoD
 //
 uint16_t GetAtoD(uint8_t Index) {
+    uint16_t Rtnval;
+
+    do {
+        Rtnval = AtoD.Channels[Index];
+        } while( Rtnval != AtoD.Channels[Index] );
 
-    return(AtoD.Channels[Index]);
+    return(Rtnval);
     }
 
 
+#ifdef ATOD_FILTER
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDGetFiltered - Return filtered AtoD Channel
+//
+// Inputs:      AtoD channel to return
+//
+// Outputs:     Filter output for channel
+//
+uint16_t AtoDGetFiltered(uint8_t Index) {
+    uint16_t Rtnval;
+
+    do {
+        Rtnval = AtoD.Filtered[Index];
+        } while( Rtnval != AtoD.Filtered[Index] );
+
+    return(Rtnval);
+    }
+#endif
+
+
+#ifdef AUTO_TRIGGER_AtoD
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDGetSamples - Get samples from a channel FIFO
+//
+// The ISR only writes FIFO_In, and this only writes FIFO_Out, so no interrupt
+//   masking is needed.
+//
+// Inputs:      Index of AtoD channel
+//              Ptr to array of samples to fill
+//              Max number of samples to return
+//
+// Outputs:     Number of samples returned, zero if none waiting
+//
+uint8_t AtoDGetSamples(uint8_t Index,uint16_t *Samples,uint8_t Max) {
+    uint8_t In  = AtoD.FIFO_In [Index];
+    uint8_t Out = AtoD.FIFO_Out[Index];
+    uint8_t nSamples = 0;
+
+    while( Out != In && nSamples < Max ) {
+        *Samples++ = AtoD.FIFO[Index][Out];
+        Out = (Out+1) & FIFO_WRAP;
+        nSamples++;
+        }
+
+    AtoD.FIFO_Out[Index] = Out;
+
+    return nSamples;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDGetDropped - Return number of samples dropped because the FIFO was full
+//
+// Inputs:      Index of AtoD channel
+//
+// Outputs:     The value specified.
+//
+uint16_t AtoDGetDropped(uint8_t Index) {
+    uint16_t Rtnval;
+
+    do {
+        Rtnval = AtoD.Dropped[Index];
+        } while( Rtnval != AtoD.Dropped[Index] );
+
+    return Rtnval;
+    }
+#endif
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -190,40 +726,82 @@ uint16_t GetAtoD(uint8_t Index) {
 //
 // Outputs:     None.
 //
+#ifdef AUTO_TRIGGER_AtoD
 ISR(ADC_vect,ISR_NOBLOCK) {
+    uint8_t  Channel  = AtoD.CurrentChannel;
+    uint16_t Sample   = ADCW;
+    bool     ScanDone = false;
+    uint8_t  NewIn;
+
+    PROFILE_ISR(PROFILE_ADC);
 
-    if( AtoD.CurrentChannel == NUM_ATOD )       // Ignore spurious interrupts
+    TIFR0 = _PIN_MASK(OCF0A);                   // Rearm the trigger
+
+    if( AtoD.Discard ) {                        // Reference settling, the next
+        AtoD.Discard = false;                   //   trigger converts it again
         return;
+        }
 
+#ifdef ATOD_OVERSAMPLE
     //
-    // Grab the current conversion
+    // Keep converting the same channel until 4^n samples have been summed
     //
-    AtoD.Channels[AtoD.CurrentChannel++] = ADCW;
+    AtoD.Accum += Sample;
+    if( --AtoD.Remaining != 0 )
+        return;
+
+    Sample = AtoDDecimate(Channel);
+#endif
 
     //
-    // If not complete, start the next conversion
+    // Move to the next entry. The mux change takes effect at the next
+    //   trigger, so the sample timing isn't affected.
     //
-    if( AtoD.CurrentChannel < NUM_ATOD ) {
+    if( LAST_REPEAT ) {
+        AtoD.CurrentChannel = NEXT_ENTRY(Channel+1);
+        if( AtoD.CurrentChannel == NUM_ATOD ) {
+            AtoD.CurrentChannel = AtoDFirstEntry();
+            ScanDone = true;
+            }
+        AtoDSelect(AtoD.CurrentChannel);
+        }
 
-        ADMUX = ADMUX_VAL | AtoD.CurrentChannel;
-        //
-        // Temp sensor requires internal 1.1v ref
-        //
-        if( AtoD.CurrentChannel == TEMP_CHANNEL )
-            _SET_BIT(ADMUX,REFS1);
+#ifdef ATOD_OVERSAMPLE
+    AtoD.Remaining = OVERSAMPLE_COUNT(AtoD.CurrentChannel);
+#endif
 
-        START_ATOD;
-        return;
+    //
+    // Save the latest value, and add to the channel FIFO if there's room
+    //
+    AtoD.Channels[Channel] = Sample;
+#ifdef ATOD_FILTER
+    AtoD.Filtered[Channel] = AtoDFilter(Channel,Sample);
+#endif
+
+    NewIn = (AtoD.FIFO_In[Channel]+1) & FIFO_WRAP;
+    if( NewIn != AtoD.FIFO_Out[Channel] ) {
+        AtoD.FIFO[Channel][AtoD.FIFO_In[Channel]] = Sample;
+        AtoD.FIFO_In[Channel] = NewIn;
         }
+    else AtoD.Dropped[Channel]++;
+
+    if( !ScanDone )
+        return;
 
     //
-    // Call the user's function
+    // Completed a scan, call the user's function
     //
 #ifdef CALL_AtoDISR
     AtoDISR();
 #endif
 
-#ifdef  ContinuousAtoD
-    StartAtoD();
+#ifdef POST_AtoDEvent
+    EventPost(EVENT_ATOD);
 #endif
     }
+#elif !defined(ATOD_SHARED)
+ISR(ADC_vect,ISR_NOBLOCK) {
+    PROFILE_ISR(PROFILE_ADC);
+    AtoDResult(ADCW);
+    }
+#endif
@@ -17,6 +17,7 @@
 //
 //      ...Choose Polled or interrupt mode   (Default: Interrupt)
 //      ...Choose continuous or command mode (Default: Continuous)
+//      ...Choose auto triggered scan mode   (Default: Off)
 //
 //      //////////////////////////////////////
 //      //
@@ -48,11 +49,104 @@
 //          ...do all update functions
 //          }
 //
+//      //////////////////////////////////////
+//      //
+//      // Auto triggered scan mode (#define AUTO_TRIGGER_AtoD)
+//      //
+//      uint16_t Samples[8];
+//
+//      AtoDInit();                         // Starts sampling at ATOD_SAMPLE_HZ
+//
+//      while(1) {
+//          uint8_t nSamples = AtoDGetSamples(1,Samples,NUMOF(Samples));
+//              :           :               // Process evenly spaced samples
+//          }
 //
 //  DESCRIPTION
 //
 //      Simple AtoD processing
 //
+//      In auto triggered scan mode, Timer0 compare match starts each conversion
+//        in hardware, so samples are evenly spaced with no software jitter. The
+//        channels are converted in turn, each conversion going into the sample
+//        FIFO for that channel. The per-channel rate is ATOD_SAMPLE_HZ/NUM_ATOD.
+//
+//      Each sample FIFO is read with AtoDGetSamples(), which takes as many
+//        samples as are waiting (up to the caller's buffer size). Samples that
+//        arrive while the FIFO is full are dropped and counted, so the caller
+//        can tell that the stream has a gap.
+//
+//      At 16 MHz the ADC clock is 125 KHz, and an auto triggered conversion
+//        takes 13.5 ADC clocks, for a maximum ATOD_SAMPLE_HZ of about 9 KHz.
+//
+//      Oversampling trades conversion rate for resolution. The samples are
+//        summed in the ISR as they arrive, so reading a result costs nothing
+//        extra. The extra bits are only real if the input has at least 1/2 LSB
+//        or so of random noise to dither it: with a perfectly clean input all
+//        4^n samples are the same and nothing is gained.
+//
+//      Effective bits, from a model of an ideal 10-bit converter with gaussian
+//        input noise (4000 random input levels per entry):
+//
+//          n   Samples     Noise = 0   Noise = 0.5 LSB   Noise = 1 LSB
+//          0       1         10.0           9.0               8.1
+//          1       4         10.0           9.9               9.1
+//          2      16         10.0          10.9              10.1
+//          3      64         10.0          11.8              11.1
+//
+//      Each result takes 4^n conversions, so at ~9600 conversions/sec the
+//        result rate for one channel is 2400/sec at n=1, 600/sec at n=2, and
+//        150/sec at n=3. In auto triggered mode the sample FIFOs hold the
+//        oversampled results, one per channel per scan, where a scan takes
+//        the sum of 4^n conversions over all channels.
+//
+//      With ATOD_FILTER, each new result is also run through a per-channel
+//        filter in the ISR. The filters take constant time per sample: the
+//        EMA and boxcar keep running sums rather than re-adding a window. The
+//        filter sees every sample, even if the main loop polls slowly.
+//
+//      GetAtoD() and AtoDGetFiltered() read their 16-bit values without
+//        masking interrupts, by re-reading until two reads agree.
+//
+//      In noise reduction mode the CPU sleeps in SLEEP_MODE_ADC during each
+//        conversion, so digital switching noise doesn't get into the result.
+//        StartAtoD() returns when the scan is complete. Other interrupts can
+//        still wake the CPU; when that happens, the remainder of that one
+//        conversion is waited out in idle mode.
+//
+//      The costs, at 16 MHz with the ADC clock at /128:
+//
+//        - Each conversion is 13 ADC clocks = 104 uS = 1664 CPU cycles, during
+//            which the CPU does nothing. Wakeup, ISR and loop overhead add
+//            roughly 100 cycles, for about 9000 conversions/sec.
+//
+//        - The I/O clock is stopped during the conversion, so Timer0, Timer1
+//            and Timer2 (unless async) stop counting: the realtime clock in
+//            Timer.c falls behind by 104 uS per conversion, or 1% at 100
+//            conversions/sec.
+//
+//        - The UART is also stopped. A character being sent or received during
+//            a conversion will be corrupted, so do noise reduction scans when
+//            the serial line is quiet (ie - after UARTBusy() returns FALSE).
+//
+//      Auto triggered mode uses Timer0, and can't be used with Freq.c or any
+//        other user of Timer0.
+//
+//      Whenever the reference changes between channels (ie - to read the temp
+//        sensor with the 1.1v ref) the first conversion is thrown away and
+//        done again, since the reference takes time to settle. Group entries
+//        with the same reference together in ATOD_SEQUENCE to avoid this.
+//
+//      With ATOD_SEQUENCE, Repeat and Every set each entry's share of the
+//        conversions: a fast channel can be read several times a scan, and a
+//        slow one (temperature, supply voltage via the bandgap) only once in
+//        many scans. A scan with no entries due is skipped.
+//
+//      With ATOD_SHARED defined in AtoDShare.h, command mode runs through
+//        AtoDShare instead of owning the ADC, so it can be used together with
+//        other AtoD drivers. Each channel is an on-request client, and a scan
+//        requests the channels in turn. Call AtoDShareInit() before AtoDInit().
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  MIT LICENSE
@@ -91,6 +185,8 @@
 // NOTE: This value can range from 1 .. 9, where the ninth channel represents the
 //         internal temperature sensor.
 //
+// NOTE: With ATOD_SEQUENCE (below) this is the number of sequence entries.
+//
 #define NUM_ATOD        1
 
 //
@@ -109,9 +205,125 @@
 // 
 //#define CALL_AtoDISR
 
+//
+// Auto triggered scan mode depends on the next definition.
+//
+// Defined (ie - uncommented) means Timer0 triggers conversions at ATOD_SAMPLE_HZ
+//   conversions per second, and every conversion is saved in a per-channel FIFO.
+//   AtoDISR is called (and EVENT_ATOD posted) after each scan of all channels.
+//
+// ATOD_FIFO_SIZE is the number of samples kept for each channel, and must be a
+//   power of two. Each sample takes 2 bytes.
+//
+//#define AUTO_TRIGGER_AtoD
+
+#define ATOD_SAMPLE_HZ  1000
+#define ATOD_FIFO_SIZE  (1 << 4)                // == 16 samples per channel
+
+//
+// Oversampling depends on the next definition.
+//
+// Defined (ie - uncommented) means each channel is converted 4^n times in a
+//   row, and the sum shifted right by n to give a 10+n bit result. The list
+//   gives n for each channel in order (0 .. 3), missing entries are zero.
+//
+// For example, 12 bit results on channel 1 and 10 bits on the others:
+//
+//   #define ATOD_OVERSAMPLE { 0, 2 }
+//
+//#define ATOD_OVERSAMPLE { 0 }
+
+//
+// Noise reduction depends on the next definition.
+//
+// Defined (ie - uncommented) means StartAtoD() runs the whole scan before
+//   returning, converting each channel with the CPU asleep in ADC noise
+//   reduction mode. Command mode only.
+//
+//#define ATOD_NOISE_REDUCTION
+
+//
+// Filtering depends on the next definition.
+//
+// Defined (ie - uncommented) means each channel's samples are also run through
+//   a filter in the ISR, with the output read by AtoDGetFiltered(). The list
+//   gives the filter for each channel in order, missing entries are ATOD_RAW:
+//
+//   ATOD_RAW           No filter, output == latest sample
+//   ATOD_EMA(k)        Exponential moving average, y += (x-y)/2^k  (k = 1 .. 8)
+//   ATOD_BOXCAR(n)     Average of the last 2^n samples             (2^n <= ATOD_HISTORY)
+//   ATOD_MEDIAN3       Median of the last 3 samples, rejects single spikes
+//
+// For example, smooth channel 0 heavily, and reject spikes on channel 1:
+//
+//   #define ATOD_FILTER { ATOD_EMA(4), ATOD_MEDIAN3 }
+//
+// ATOD_HISTORY is the number of samples kept for each channel for the boxcar and
+//   median filters, and must be a power of two. Each sample takes 2 bytes.
+//
+//#define ATOD_FILTER { ATOD_RAW }
+
+#define ATOD_HISTORY    (1 << 3)                // == 8 samples per channel
+
+//
+// Channel sequence depends on the next definition.
+//
+// Defined (ie - uncommented) means the scan follows this table instead of
+//   inputs 0 .. NUM_ATOD-1. Each entry is { Mux, Ref, Repeat, Every }:
+//
+//   Mux        ATOD_ADC(n), ATOD_TEMP, ATOD_BANDGAP, ATOD_GND, or a differential
+//                mux value on the 2560 (see AtoDShare.h)
+//   Ref        ATOD_REF_AVCC, ATOD_REF_1V1, ATOD_REF_AREF (or ATOD_REF_2V56 on 2560)
+//   Repeat     Readings taken in a row each time the entry is due (0 == 1)
+//   Every      Entry is due once every Every scans (0 == 1)
+//
+// GetAtoD(n) and the other per-channel functions then take the entry number.
+//
+// For example, input 0 twice a scan, input 3 every scan, and the temp sensor
+//   every 100th scan:
+//
+//   #define NUM_ATOD       3
+//   #define ATOD_SEQUENCE  { { ATOD_ADC(0), ATOD_REF_AVCC, 2,   1 },
+//                            { ATOD_ADC(3), ATOD_REF_AVCC, 1,   1 },
+//                            { ATOD_TEMP,   ATOD_REF_1V1,  1, 100 } }
+//
+// (with a backslash at the end of each continued line)
+//
+//#define ATOD_SEQUENCE { { ATOD_ADC(0), ATOD_REF_AVCC, 1, 1 } }
+
+//
+// Event loop posting depends on the next definition.
+//
+// Defined (ie - uncommented) means post EVENT_ATOD when all channels have
+//   been converted. See Event.h
+//
+//#define POST_AtoDEvent
+
 //
 // End of user configurable options
 //
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#define ATOD_FILTER_RAW     0x00
+#define ATOD_FILTER_EMA     0x10
+#define ATOD_FILTER_BOXCAR  0x20
+#define ATOD_FILTER_MEDIAN3 0x30
+
+#define ATOD_RAW            ATOD_FILTER_RAW
+#define ATOD_EMA(_k_)       (ATOD_FILTER_EMA    | (_k_))
+#define ATOD_BOXCAR(_n_)    (ATOD_FILTER_BOXCAR | (_n_))
+#define ATOD_MEDIAN3        ATOD_FILTER_MEDIAN3
+
+typedef struct {
+    uint8_t     Mux;                            // Input, ie - ATOD_ADC(n)
+    uint8_t     Ref;                            // Reference, ie - ATOD_REF_AVCC
+    uint8_t     Repeat;                         // Readings in a row when due
+    uint8_t     Every;                          // Due once every Every scans
+    } ATOD_SEQ_T;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -156,8 +368,72 @@ bool AtoDComplete(void);
 //
 // Inputs:      Index of AtoD value to get
 //
-// Outputs:     None.
+// Outputs:     Last value, 10 bits plus any oversampling bits for the channel
 //
 uint16_t GetAtoD(uint8_t Index);
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDGetFiltered - Get filter output for a channel
+//
+// Inputs:      Index of AtoD channel
+//
+// Outputs:     Latest filter output, see ATOD_FILTER above
+//
+// NOTE: Only defined if ATOD_FILTER is #defined, see above.
+//
+#ifdef ATOD_FILTER
+uint16_t AtoDGetFiltered(uint8_t Index);
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDGetSamples - Get samples from a channel FIFO
+//
+// Samples are removed from the FIFO in the order they were taken.
+//
+// Inputs:      Index of AtoD channel
+//              Ptr to array of samples to fill
+//              Max number of samples to return
+//
+// Outputs:     Number of samples returned, zero if none waiting
+//
+// NOTE: Only defined if AUTO_TRIGGER_AtoD is #defined, see above.
+//
+#ifdef AUTO_TRIGGER_AtoD
+uint8_t AtoDGetSamples(uint8_t Index,uint16_t *Samples,uint8_t Max);
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDGetDropped - Return number of samples dropped because the FIFO was full
+//
+// Inputs:      Index of AtoD channel
+//
+// Outputs:     The value specified.
+//
+// NOTE: Only defined if AUTO_TRIGGER_AtoD is #defined, see above.
+//
+#ifdef AUTO_TRIGGER_AtoD
+uint16_t AtoDGetDropped(uint8_t Index);
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDISR - User's AtoD completion routine
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+// NOTE: Only defined if CALL_AtoDISR is #defined, see above.
+//
+#ifdef CALL_AtoDISR
+void AtoDISR(void);
+#endif
+
 #endif  // ATOD_H - entire file
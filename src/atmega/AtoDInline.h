@@ -28,6 +28,10 @@
 //
 //      A simple AtoD module using polled inline code.
 //
+//      With ATOD_SHARED defined in AtoDShare.h, each read goes through
+//        AtoDShareRead() instead, so other AtoD drivers can run at the same
+//        time. AtoDShareInit() must be called before AtoDInit.
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  MIT LICENSE
@@ -55,6 +59,8 @@
 #ifndef AtoDInline_H
 #define AtoDInline_H
 
+#include "AtoDShare.h"
+
 //
 // Convenience macros
 //
@@ -68,6 +74,15 @@
 //
 #define ADCSRA_VAL  _PIN_MASK(ADPS2) | _PIN_MASK(ADPS1) | _PIN_MASK(ADPS0) | _PIN_MASK(ADEN)
 
+#ifdef ATOD_SHARED
+#define AtoDInit                            /* AtoDShareInit does it    */
+
+#define AtoDRead(_Channel_,_Result_) {                                                  \
+    _Result_ = AtoDShareRead(ADMUX_VAL(_Channel_),ATOD_PRESCALE_128);                   \
+    }                                                                                   \
+
+#else
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -103,4 +118,6 @@
     _Result_ = ADCW;                                                                    \
     }                                                                                   \
 
+#endif // ATOD_SHARED
+
 #endif // AtoDInline_H - entire file
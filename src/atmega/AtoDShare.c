@@ -0,0 +1,396 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//
+//  FILE
+//      AtoDShare.c
+//
+//  DESCRIPTION
+//
+//      Shared AtoD arbitration
+//
+//      Schedule conversions for several AtoD drivers on the one ADC.
+//
+//      See AtoDShare.h for an in-depth description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "AtoDShare.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define IDLE_SLOT   0xFE                        // Conversion for timing only
+
+static volatile struct {
+    ATOD_CLIENT Clients[ATOD_MAX_CLIENTS];      // Registered clients
+    uint8_t     Wait   [ATOD_MAX_CLIENTS];      // Slots until periodic client is due
+    bool        Pending[ATOD_MAX_CLIENTS];      // Conversion requested
+    uint8_t     nClients;                       // Number of registered clients
+    uint8_t     Current;                        // Client being converted
+    uint8_t     Last;                           // Last client converted
+    bool        Discard;                        // Current conversion is ref settling
+    bool        Locked;                         // Polled client has the ADC
+    } AtoDShare NOINIT;
+
+#define START_ATOD  { _SET_BIT(ADCSRA,ADSC); }  // Start the AtoD conversion
+#define WAIT_ATOD   { while(_BIT_ON(ADCSRA,ADSC)); }
+
+static void AtoDShareNext(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareInit - Initialize shared AtoD
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void AtoDShareInit(void) {
+
+    memset((void *) &AtoDShare,0,sizeof(AtoDShare));
+
+    AtoDShare.Current = ATOD_NO_CLIENT;
+
+    //
+    // Setup AtoD for interrupts, the clients set their own channels
+    //
+    _CLR_BIT(PRR,PRADC);                    // Powerup the A/D converter
+
+    DIDR0  = 0;                             // Turn off digital outputs
+    ADCSRB = 0;                             // No auto trigger
+    ADMUX  = ATOD_REF_AVCC;
+    ADCSRA = _PIN_MASK(ADEN) | _PIN_MASK(ADIE) | _PIN_MASK(ADIF) | ATOD_PRESCALE_128;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareAdd - Register an ISR client
+//
+// Inputs:      Ptr to client settings
+//
+// Outputs:     Handle of client, or ATOD_NO_CLIENT if the table is full
+//
+uint8_t AtoDShareAdd(const ATOD_CLIENT *Client) {
+    uint8_t SaveSREG = SREG;
+    uint8_t Handle;
+
+    cli();
+
+    if( AtoDShare.nClients >= ATOD_MAX_CLIENTS ) {
+        SREG = SaveSREG;
+        return ATOD_NO_CLIENT;
+        }
+
+    Handle = AtoDShare.nClients;
+    AtoDShare.Clients[Handle].Mux      = Client->Mux;
+    AtoDShare.Clients[Handle].Prescale = Client->Prescale;
+    AtoDShare.Clients[Handle].Period   = Client->Period;
+    AtoDShare.Clients[Handle].Result   = Client->Result;
+    AtoDShare.Wait   [Handle]          = 0;
+    AtoDShare.Pending[Handle]          = false;
+    AtoDShare.nClients++;
+
+    if( AtoDShare.Current == ATOD_NO_CLIENT && !AtoDShare.Locked )
+        AtoDShareNext();                    // Start periodic client
+
+    SREG = SaveSREG;
+
+    return Handle;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareRequest - Request one conversion for a client
+//
+// Inputs:      Handle of client
+//
+// Outputs:     None.
+//
+void AtoDShareRequest(uint8_t Handle) {
+    uint8_t SaveSREG = SREG;
+
+    if( Handle >= AtoDShare.nClients )
+        return;
+
+    cli();                                  // Interrupts may also request
+
+    AtoDShare.Pending[Handle] = true;
+
+    if( AtoDShare.Current == ATOD_NO_CLIENT && !AtoDShare.Locked )
+        AtoDShareNext();                    // ADC was idle, start now
+
+    SREG = SaveSREG;                        // Restore interrupt state
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDConfigure - Set up the ADC, changing only what's needed
+//
+// Inputs:      ADMUX value
+//              One of ATOD_PRESCALE_xxx
+//
+// Outputs:     TRUE  if the reference changed, and the next conversion should be discarded
+//              FALSE if the next conversion is good
+//
+// NOTE: Must be called with no conversion in progress.
+//
+static bool AtoDConfigure(uint8_t Mux,uint8_t Prescale) {
+    bool RefChanged = ((ADMUX ^ Mux) & ATOD_REF_MASK) != 0;
+
+    if( ADMUX != Mux )
+        ADMUX = Mux;
+
+    //
+    // Writing a 1 to ADIF would clear it, so mask it out of the write
+    //
+    if( (ADCSRA & ATOD_PRESCALE_MASK) != Prescale )
+        ADCSRA = (ADCSRA & ~(ATOD_PRESCALE_MASK | _PIN_MASK(ADIF))) | Prescale;
+
+    return RefChanged;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareNext - Start the next conversion
+//
+// Due clients are checked in round robin order starting after the last one
+//   converted, and the first due client that needs no ADC changes wins. The
+//   last client converted can't win that way, so a client with the same
+//   settings every slot can't starve the others.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+// NOTE: Must be called with interrupts disabled.
+//
+static void AtoDShareNext(void) {
+    uint8_t Next     = ATOD_NO_CLIENT;
+    bool    Periodic = false;
+    uint8_t Client   = AtoDShare.Last;
+
+    for( uint8_t i=0; i<AtoDShare.nClients; i++ ) {
+        if( ++Client >= AtoDShare.nClients )
+            Client = 0;
+
+        if( AtoDShare.Clients[Client].Period )
+            Periodic = true;
+
+        if( !AtoDShare.Pending[Client] &&
+            (AtoDShare.Clients[Client].Period == 0 || AtoDShare.Wait[Client] != 0) )
+            continue;
+
+        if( Next == ATOD_NO_CLIENT )
+            Next = Client;
+
+        if( Client != AtoDShare.Last                                      &&
+            AtoDShare.Clients[Client].Mux      == ADMUX                   &&
+            AtoDShare.Clients[Client].Prescale == (ADCSRA & ATOD_PRESCALE_MASK) ) {
+            Next = Client;
+            break;
+            }
+        }
+
+    //
+    // Nobody due: keep the periodic clients on time with a throwaway conversion
+    //
+    if( Next == ATOD_NO_CLIENT ) {
+        if( Periodic ) {
+            AtoDShare.Current = IDLE_SLOT;
+            START_ATOD;
+            }
+        else AtoDShare.Current = ATOD_NO_CLIENT;
+        return;
+        }
+
+    AtoDShare.Current         = Next;
+    AtoDShare.Last            = Next;
+    AtoDShare.Pending[Next]   = false;
+    AtoDShare.Wait[Next]      = AtoDShare.Clients[Next].Period;
+    AtoDShare.Discard         = AtoDConfigure(AtoDShare.Clients[Next].Mux,AtoDShare.Clients[Next].Prescale);
+    START_ATOD;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareLock - Take the ADC for polled conversions
+//
+// Inputs:      ADMUX value
+//              One of ATOD_PRESCALE_xxx
+//
+// Outputs:     None.
+//
+void AtoDShareLock(uint8_t Mux,uint8_t Prescale) {
+
+    cli();
+    AtoDShare.Locked = true;                // ISR won't start another
+    sei();
+
+    while( AtoDShare.Current != ATOD_NO_CLIENT )
+        ;                                   // ISR finishes the one in progress
+
+    _CLR_BIT(ADCSRA,ADIE);                  // Polled from here on
+
+    if( AtoDConfigure(Mux,Prescale) ) {
+        START_ATOD;                         // Let the new reference settle
+        WAIT_ATOD;
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareConvert - Do one conversion while locked
+//
+// Inputs:      None.
+//
+// Outputs:     ADCW result of conversion
+//
+uint16_t AtoDShareConvert(void) {
+
+    START_ATOD;
+    WAIT_ATOD;
+
+    return ADCW;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareUnlock - Return the ADC to the scheduler
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void AtoDShareUnlock(void) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+
+    ADCSRA |= _PIN_MASK(ADIF) | _PIN_MASK(ADIE);    // Clear polled ADIF, enable ints
+    AtoDShare.Locked = false;
+    AtoDShareNext();
+
+    SREG = SaveSREG;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareRead - Do one polled conversion
+//
+// Inputs:      ADMUX value
+//              One of ATOD_PRESCALE_xxx
+//
+// Outputs:     ADCW result of conversion
+//
+uint16_t AtoDShareRead(uint8_t Mux,uint8_t Prescale) {
+    uint16_t Rtnval;
+
+    AtoDShareLock(Mux,Prescale);
+    Rtnval = AtoDShareConvert();
+    AtoDShareUnlock();
+
+    return Rtnval;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ADC_vect - A/D interrupt processing
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(ADC_vect,ISR_NOBLOCK) {
+    uint8_t  Client = AtoDShare.Current;
+    uint16_t Sample = ADCW;
+
+    if( Client == ATOD_NO_CLIENT )          // Ignore spurious interrupts
+        return;
+
+    //
+    // Every conversion is a slot, whoever it was for
+    //
+    for( uint8_t i=0; i<AtoDShare.nClients; i++ )
+        if( AtoDShare.Wait[i] )
+            AtoDShare.Wait[i]--;
+
+    //
+    // Settling conversion after a reference change: convert the same client
+    //   again, unless a polled client is waiting.
+    //
+    if( AtoDShare.Discard ) {
+        AtoDShare.Discard = false;
+        if( !AtoDShare.Locked ) {
+            START_ATOD;
+            return;
+            }
+        AtoDShare.Pending[Client] = true;   // Redo it after the unlock
+        AtoDShare.Current = ATOD_NO_CLIENT;
+        return;
+        }
+
+    if( Client != IDLE_SLOT )
+        AtoDShare.Clients[Client].Result(Sample);
+
+    //
+    // Result functions run with interrupts on, and may have made requests
+    //
+    cli();
+    if( AtoDShare.Locked ) AtoDShare.Current = ATOD_NO_CLIENT;
+    else                   AtoDShareNext();
+    }
@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//
+//  FILE
+//      AtoDShare.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In AtoDShare.h
+//      //
+//      ...Uncomment ATOD_SHARED to make the AtoD drivers share the ADC
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c
+//      //
+//      AtoDShareInit();                    // Called once, before the other inits
+//      AtoDInit();                         // Each of these registers with AtoDShare
+//      ACS712Init();
+//      TPDevInit();
+//          :
+//
+//      //////////////////////////////////////
+//      //
+//      // In a driver (ISR client)
+//      //
+//      static void MyResult(uint16_t Sample) { ... }  // Called from the ISR
+//
+//      static const ATOD_CLIENT MyClient = {
+//          ATOD_REF_AVCC | 3,              // Channel 3, AVCC reference
+//          ATOD_PRESCALE_128,              // 125 KHz ADC clock
+//          10,                             // One sample every 10 slots
+//          MyResult };
+//
+//      Handle = AtoDShareAdd(&MyClient);
+//
+//      //////////////////////////////////////
+//      //
+//      // In a driver (polled client)
+//      //
+//      Value = AtoDShareRead(ATOD_REF_AVCC | 3,ATOD_PRESCALE_128);
+//
+//  DESCRIPTION
+//
+//      Shared AtoD arbitration
+//
+//      Only one module can own ISR(ADC_vect), and any module that writes ADMUX
+//        or ADCSRA will corrupt conversions belonging to another. This module
+//        owns the ADC, and the other AtoD drivers (AtoD.c, ACS712.c, TCD1304.c
+//        and TPDev.c) go through it when ATOD_SHARED is defined.
+//
+//      ISR clients register their settings: the ADMUX value (channel, reference
+//        and ADLAR) and the ADC clock prescaler, along with a function that the
+//        ISR calls with each result.
+//
+//      Each conversion is one "slot". A client with a nonzero Period gets one
+//        slot out of every Period, for a fixed sample rate. A client with a zero
+//        Period is only converted when it calls AtoDShareRequest(), once per
+//        request. If no client is due, the ADC converts anyway and throws the
+//        result away, so the slot timing stays fixed.
+//
+//      When several clients are due, the scheduler picks one whose settings
+//        match the current ADC settings, so nothing needs to be written to the
+//        ADC. Otherwise clients take turns in round robin order.
+//
+//      A reference change needs time to settle, so the first conversion after
+//        one is thrown away and that client is converted again. Put clients
+//        that use the same reference together, and avoid changing reference
+//        often.
+//
+//      Polled clients call AtoDShareRead(), which waits for the conversion in
+//        progress to finish, pauses the scheduler, and does one conversion
+//        with the given settings. A client that needs the ADC for a longer time
+//        (ie - with critical timing) calls AtoDShareLock(), then any number of
+//        AtoDShareConvert(), then AtoDShareUnlock().
+//
+//  NOTES
+//
+//      A slot takes 13 ADC clocks, so the rate of a periodic client depends
+//        on the prescaler of each client converted:
+//
+//          Prescale    ADC clock   Slot        Slots/sec
+//            128       125   KHz   104 uS       9615
+//             64       250   KHz    52 uS      19230
+//             16         1   MHz    13 uS      76923
+//
+//      Prescales faster than 128 give less than 10 bits of accuracy at 16 MHz.
+//
+//      The result functions are called from the ISR with interrupts enabled,
+//        and should be short.
+//
+//      AtoDShareLock() and AtoDShareRead() must be called with interrupts
+//        enabled, since they wait for the ISR to finish the current conversion.
+//
+//      Not usable with the AUTO_TRIGGER_AtoD or ATOD_NOISE_REDUCTION modes of
+//        AtoD.c, which need the ADC to themselves.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ATODSHARE_H
+#define ATODSHARE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <avr/io.h>
+
+#include "PortMacros.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Sharing depends on the next definition.
+//
+// Defined (ie - uncommented) means the AtoD drivers (AtoD.c, ACS712.c, TCD1304.c
+//   and TPDev.c) use this module instead of programming the ADC directly, so
+//   any of them can be used together. AtoDShareInit() must then be called
+//   before any of the driver inits.
+//
+// Undefined means each driver owns the ADC, and only one of them may be used.
+//
+//#define ATOD_SHARED
+
+//
+// Max number of ISR clients. AtoD.c uses one client per channel.
+//
+#define ATOD_MAX_CLIENTS    12
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+// ADMUX settings are a reference, optionally ATOD_LEFT_ADJUST, plus the channel.
+//
+#define ATOD_REF_AREF       0
+#define ATOD_REF_AVCC       _PIN_MASK(REFS0)
+#if defined(_AVR_IOM2560_H_)
+#define ATOD_REF_1V1        _PIN_MASK(REFS1)
+#define ATOD_REF_2V56       (_PIN_MASK(REFS1) | _PIN_MASK(REFS0))
+#else
+#define ATOD_REF_1V1        (_PIN_MASK(REFS1) | _PIN_MASK(REFS0))
+#endif
+#define ATOD_REF_MASK       (_PIN_MASK(REFS1) | _PIN_MASK(REFS0))
+
+//
+// Channel (mux) values. On the 2560 mux values are 6 bits, with bit 5 going
+//   to MUX5 in ADCSRB, and differential channels can be used directly from
+//   the mux table in the datasheet (ie - 0x09 is ADC1-ADC0 with 10x gain).
+//   AtoDShare clients are limited to the low 5 bits.
+//
+#if defined(_AVR_IOM2560_H_)
+#define ATOD_ADC(_n_)       ((_n_) < 8 ? (_n_) : 0x20 + (_n_) - 8)
+#define ATOD_BANDGAP        0x1E                // 1.1v internal reference
+#define ATOD_GND            0x1F
+#else
+#define ATOD_ADC(_n_)       (_n_)
+#define ATOD_TEMP           8                   // Temp sensor, use with ATOD_REF_1V1
+#define ATOD_BANDGAP        14                  // 1.1v internal reference
+#define ATOD_GND            15
+#endif
+#define ATOD_LEFT_ADJUST    _PIN_MASK(ADLAR)    // 8-bit result in ADCH
+
+#define ATOD_PRESCALE_2     1
+#define ATOD_PRESCALE_4     2
+#define ATOD_PRESCALE_8     3
+#define ATOD_PRESCALE_16    4
+#define ATOD_PRESCALE_32    5
+#define ATOD_PRESCALE_64    6
+#define ATOD_PRESCALE_128   7
+#define ATOD_PRESCALE_MASK  7
+
+#define ATOD_NO_CLIENT      0xFF
+
+typedef struct {
+    uint8_t     Mux;                            // ADMUX value
+    uint8_t     Prescale;                       // One of ATOD_PRESCALE_xxx
+    uint8_t     Period;                         // Slots per sample, 0 == on request
+    void      (*Result)(uint16_t Sample);       // Called from ISR with each result
+    } ATOD_CLIENT;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareInit - Initialize shared AtoD
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void AtoDShareInit(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareAdd - Register an ISR client
+//
+// The settings are copied, so the client struct need not be kept. Periodic
+//   clients start being converted immediately.
+//
+// Inputs:      Ptr to client settings
+//
+// Outputs:     Handle of client, or ATOD_NO_CLIENT if the table is full
+//
+uint8_t AtoDShareAdd(const ATOD_CLIENT *Client);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareRequest - Request one conversion for a client
+//
+// The result is passed to the client's result function. Requests are not
+//   counted: requesting again before the result arrives has no effect.
+//
+// May be called from the client's result function, or any other ISR.
+//
+// Inputs:      Handle of client
+//
+// Outputs:     None.
+//
+void AtoDShareRequest(uint8_t Handle);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareLock - Take the ADC for polled conversions
+//
+// Waits for the conversion in progress to finish, then stops the scheduler
+//   and sets up the ADC as given. ADC interrupts are disabled until unlocked.
+//
+// Inputs:      ADMUX value
+//              One of ATOD_PRESCALE_xxx
+//
+// Outputs:     None.
+//
+void AtoDShareLock(uint8_t Mux,uint8_t Prescale);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareConvert - Do one conversion while locked
+//
+// Inputs:      None.
+//
+// Outputs:     ADCW result of conversion
+//
+uint16_t AtoDShareConvert(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareUnlock - Return the ADC to the scheduler
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void AtoDShareUnlock(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareRead - Do one polled conversion
+//
+// Inputs:      ADMUX value
+//              One of ATOD_PRESCALE_xxx
+//
+// Outputs:     ADCW result of conversion
+//
+uint16_t AtoDShareRead(uint8_t Mux,uint8_t Prescale);
+
+#endif  // ATODSHARE_H - entire file
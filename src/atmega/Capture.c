@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Capture.c
+//
+//  DESCRIPTION
+//
+//      Input capture timestamping
+//
+//      Timestamp every edge on ICP1 with a 32-bit timer count.
+//
+//      See Capture.h for an in-depth description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "Capture.h"
+#include "TimerMacros.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define FIFO_WRAP   (CAPTURE_FIFO_SIZE-1)
+
+static volatile struct {
+    CAPTURE_T   FIFO[CAPTURE_FIFO_SIZE];            // Captured events
+    uint8_t     FIFO_In;                            // FIFO input  pointer
+    uint8_t     FIFO_Out;                           // FIFO output pointer
+    uint16_t    TimerExt;                           // Upper 16 bits of timestamp
+    uint16_t    Missed;                             // Events dropped, FIFO full
+    } Capture NOINIT;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Setup some port designations
+//
+#undef TIMER_ID                                     // Prevents typos in following
+
+#define CAPTURE_TIMER_ID 1
+#define PRTIMx          _PRTIM(CAPTURE_TIMER_ID)
+#define CAPTURE_ISR     _TCAPT_VECT(CAPTURE_TIMER_ID)
+#define OFLO_ISR        _TOVF_VECT(CAPTURE_TIMER_ID)
+
+#define TCCRAx          _TCCRA(CAPTURE_TIMER_ID)
+#define TCCRBx          _TCCRB(CAPTURE_TIMER_ID)
+#define TIMSKx          _TIMSK(CAPTURE_TIMER_ID)
+#define TIFRx           _TIFR(CAPTURE_TIMER_ID)
+#define TCNTx           _TCNT(CAPTURE_TIMER_ID)
+#define ICRx            _ICR(CAPTURE_TIMER_ID)
+#define ICIEx           _ICIE(CAPTURE_TIMER_ID)
+#define TOIEx           _TOIE(CAPTURE_TIMER_ID)
+#define ICFx            _ICF(CAPTURE_TIMER_ID)
+#define TOVx            _TOV(CAPTURE_TIMER_ID)
+
+#define RISING_EDGE     _ICES(CAPTURE_TIMER_ID)
+
+#define CAPTURE_CLOCK   _PIN_MASK(_CS0(CAPTURE_TIMER_ID))  // clk I/O /1
+
+#ifdef CAPTURE_NOISE_CANCEL
+#define CAPTURE_FILTER  _PIN_MASK(_ICNC(CAPTURE_TIMER_ID))
+#else
+#define CAPTURE_FILTER  0
+#endif
+
+#if CAPTURE_EDGES == CAPTURE_FALLING
+#define CAPTURE_START   0
+#else
+#define CAPTURE_START   _PIN_MASK(RISING_EDGE)
+#endif
+
+#if defined(_AVR_IOM1284P_H_)
+#define ICP_PORT        D                           // ICP1 == PD6
+#define ICP_PIN         6
+#define CPUPRR          PRR0
+#elif defined(_AVR_IOM2560_H_)
+#define ICP_PORT        D                           // ICP1 == PD4
+#define ICP_PIN         4
+#define CPUPRR          PRR0
+#else
+#define ICP_PORT        B                           // ICP1 == PB0
+#define ICP_PIN         0
+#define CPUPRR          PRR
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureInit - Initialize input capture
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void CaptureInit(void) {
+
+    memset((void *) &Capture,0,sizeof(Capture));
+
+    _CLR_BIT(CPUPRR,PRTIMx);                        // Powerup the clock
+
+    _CLR_BIT(_DDR(ICP_PORT),ICP_PIN);               // ICP is an input
+
+    //
+    // Setup the timer as free running at full clock speed
+    //
+    TCCRAx = 0;                                     // Normal counter
+    TCCRBx = CAPTURE_CLOCK | CAPTURE_FILTER | CAPTURE_START;
+    TCNTx  = 0;
+
+    TIFRx  = _PIN_MASK(ICFx) | _PIN_MASK(TOVx);     // Clear stale flags
+    TIMSKx = _PIN_MASK(ICIEx) | _PIN_MASK(TOIEx);   // Allow interrupts
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureRead - Get captured events
+//
+// The ISR only writes FIFO_In, and this only writes FIFO_Out, so no interrupt
+//   masking is needed.
+//
+// Inputs:      Ptr to array of events to fill
+//              Max number of events to return
+//
+// Outputs:     Number of events returned, zero if none waiting
+//
+uint8_t CaptureRead(CAPTURE_T *Events,uint8_t Max) {
+    uint8_t In  = Capture.FIFO_In;
+    uint8_t Out = Capture.FIFO_Out;
+    uint8_t nEvents = 0;
+
+    while( Out != In && nEvents < Max ) {
+        *Events++ = Capture.FIFO[Out];
+        Out = (Out+1) & FIFO_WRAP;
+        nEvents++;
+        }
+
+    Capture.FIFO_Out = Out;
+
+    return nEvents;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureCount - Return number of events waiting in FIFO
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint8_t CaptureCount(void) {
+
+    return (Capture.FIFO_In - Capture.FIFO_Out) & FIFO_WRAP;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureGetTime - Return current timestamp
+//
+// If the timer overflows during the read, the overflow ISR changes TimerExt and
+//   the read is done again.
+//
+// Inputs:      None.
+//
+// Outputs:     Current 32-bit timer count
+//
+uint32_t CaptureGetTime(void) {
+    uint16_t Ext;
+    uint16_t Count;
+
+    do {
+        Ext   = Capture.TimerExt;
+        Count = TCNTx;
+        } while( Ext != Capture.TimerExt );
+
+    return ((uint32_t) Ext << 16) | Count;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureGetMissed - Return number of events dropped because the FIFO was full
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint16_t CaptureGetMissed(void) {
+    uint16_t Rtnval;
+
+    do {
+        Rtnval = Capture.Missed;
+        } while( Rtnval != Capture.Missed );
+
+    return Rtnval;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMERx_CAPT_vect - Input capture causes an interrupt
+//
+// The overflow flag is checked here because an overflow just before the edge
+//   may not have been serviced yet. A small ICR value means the capture was
+//   after the overflow, so the pending overflow belongs to this timestamp.
+//
+// Runs with interrupts off, so the overflow ISR can't change TimerExt in the
+//   middle of this.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(CAPTURE_ISR) {
+    uint16_t Count  = ICRx;
+    uint16_t Ext    = Capture.TimerExt;
+    bool     Rising = _BIT_ON(TCCRBx,RISING_EDGE);
+    uint8_t  NewIn;
+
+    if( _BIT_ON(TIFRx,TOVx) && Count < 0x8000 )
+        Ext++;
+
+#if CAPTURE_EDGES == CAPTURE_BOTH
+    //
+    // Look for the opposite edge next. Changing the edge can set ICF, so clear
+    //   it afterwards.
+    //
+    TCCRBx ^= _PIN_MASK(RISING_EDGE);
+    TIFRx   = _PIN_MASK(ICFx);
+#endif
+
+    //
+    // If there's room in the FIFO, add the new event
+    //
+    NewIn = (Capture.FIFO_In+1) & FIFO_WRAP;
+
+    if( NewIn == Capture.FIFO_Out ) {
+        Capture.Missed++;
+        return;
+        }
+
+    Capture.FIFO[Capture.FIFO_In].Time   = ((uint32_t) Ext << 16) | Count;
+    Capture.FIFO[Capture.FIFO_In].Rising = Rising;
+    Capture.FIFO_In = NewIn;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMERx_OVF_vect - Overflow timer count
+//
+// Just increment the extended word, making an equivalent 32-bit timer
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(OFLO_ISR) { Capture.TimerExt++; }
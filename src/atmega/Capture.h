@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Capture.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // On Circuitboard
+//      //
+//      Hook up the signal to ICP1 (PortB.0)
+//
+//      //////////////////////////////////////
+//      //
+//      // In Capture.h
+//      //
+//      ...Choose edges to capture         (Default: Both)
+//      ...Choose noise canceller          (Default: Off)
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c
+//      //
+//      CAPTURE_T   Events[8];
+//
+//      CaptureInit();                      // Called once at startup
+//          :
+//
+//      while(1) {
+//          uint8_t nEvents = CaptureRead(Events,NUMOF(Events));
+//
+//          for( uint8_t i=0; i<nEvents; i++ )
+//              ...Events[i].Time is the timestamp, Events[i].Rising the edge
+//          }
+//
+//  DESCRIPTION
+//
+//      Input capture timestamping
+//
+//      Timer1 runs free at the full CPU clock, extended to 32 bits by counting
+//        overflows. Each edge on ICP1 latches the timer in hardware, and the
+//        ISR stores the 32-bit timestamp and the edge polarity in a FIFO.
+//
+//      At 16 MHz each count is 62.5 ns, and the timestamps wrap every 268
+//        seconds. Take differences of timestamps (unsigned subtraction) rather
+//        than comparing them, and the wrap takes care of itself.
+//
+//      Since the timer is latched by hardware, the timestamp does not depend on
+//        interrupt latency. Latency only limits how close together two edges can
+//        be and still both be seen (about 3 uS when capturing both edges).
+//
+//      Every edge is kept, so pulse widths, periods, duty cycle, frequency and
+//        bit timing can all be computed from the one event stream by the
+//        consumer. Events arriving while the FIFO is full are dropped, and
+//        counted by CaptureGetMissed().
+//
+//      When capturing both edges the ISR switches the edge select after each
+//        capture. If the input changes twice before the ISR gets there, one
+//        edge is lost and two events of the same polarity will be seen in a
+//        row; check the Rising field rather than assuming events alternate.
+//
+//  NOTES
+//
+//      Uses Timer1 exclusively: this module can't be used together with PWM.c,
+//        or with EVENT_STATS in Event.h if it uses Timer1.
+//
+//      The noise canceller requires 4 equal samples of the input before a
+//        change is recognized, which delays every timestamp by 4 CPU clocks.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Edges to capture
+//
+// CAPTURE_EDGES is one of
+//
+//   CAPTURE_RISING         Rising  edges only
+//   CAPTURE_FALLING        Falling edges only
+//   CAPTURE_BOTH           Both edges
+//
+#define CAPTURE_RISING  1
+#define CAPTURE_FALLING 2
+#define CAPTURE_BOTH    3
+
+#define CAPTURE_EDGES   CAPTURE_BOTH
+
+//
+// Noise canceller depends on the next definition.
+//
+// Defined (ie - uncommented) means enable the input capture noise canceller,
+//   which ignores glitches shorter than 4 CPU clocks at the cost of a fixed
+//   4 clock delay.
+//
+//#define CAPTURE_NOISE_CANCEL
+
+//
+// The FIFO must be a power of two long, since the code uses masking to wrap
+//   the index. Each entry takes 5 bytes.
+//
+#ifndef CAPTURE_FIFO_SIZE
+#define CAPTURE_FIFO_SIZE   (1 << 4)                // == 16 events
+#endif
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+typedef struct {
+    uint32_t    Time;                               // Timer1 count at edge
+    bool        Rising;                             // TRUE if rising edge
+    } CAPTURE_T;
+
+#define CAPTURE_HZ              F_CPU               // Timestamp counts per second
+#define CAPTURE_TO_NS(_c_)      ((_c_)*(1000000000UL/CAPTURE_HZ))
+#define CAPTURE_TO_US(_c_)      ((_c_)/(CAPTURE_HZ/1000000UL))
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureInit - Initialize input capture
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void CaptureInit(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureRead - Get captured events
+//
+// Events are removed from the FIFO in the order they happened.
+//
+// Inputs:      Ptr to array of events to fill
+//              Max number of events to return
+//
+// Outputs:     Number of events returned, zero if none waiting
+//
+uint8_t CaptureRead(CAPTURE_T *Events,uint8_t Max);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureCount - Return number of events waiting in FIFO
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint8_t CaptureCount(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureGetTime - Return current timestamp
+//
+// For comparing with event timestamps, ie - to detect a signal that has stopped.
+//
+// Inputs:      None.
+//
+// Outputs:     Current 32-bit timer count
+//
+uint32_t CaptureGetTime(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureGetMissed - Return number of events dropped because the FIFO was full
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint16_t CaptureGetMissed(void);
+
+#endif  // CAPTURE_H - entire file
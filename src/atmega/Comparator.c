@@ -39,16 +39,41 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
+
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
 #include "Comparator.h"
 #include "PortMacros.h"
+#include "TimerMacros.h"
 
 #ifndef CALL_ComparatorISR
-bool ComparatorHit;
+volatile bool ComparatorHit;
 #endif
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static volatile struct {
+    uint32_t    Count;                              // Events since last ComparatorGetCount()
+#ifdef COMPARATOR_CAPTURE
+    uint16_t    TimerExt;                           // Upper 16 bits of timestamp
+    uint32_t    Last[2];                            // Time of last trip, by direction
+    bool        HaveLast[2];                        // TRUE if Last[] is valid
+    uint32_t    PeriodSum;                          // Total time between like trips
+    uint32_t    PeriodMin;                          // Shortest time between like trips
+    uint32_t    PeriodMax;                          // Longest  time between like trips
+    uint16_t    Periods;                            // Number of periods in totals
+    uint16_t    Trips;                              // Number of trips
+#endif
+    } Comparator NOINIT;
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
 // Setup some port designations
@@ -78,12 +103,66 @@ bool ComparatorHit;
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-#ifdef USE_T1CAPTIRE
+#if defined(USE_T1CAPTURE) || defined(COMPARATOR_CAPTURE)
     #define T1CAPTURE (_PIN_MASK(ACIC))
 #else
     #define T1CAPTURE (0)
 #endif
 
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef COMPARATOR_CAPTURE
+#undef TIMER_ID                                     // Prevents typos in following
+
+#define CAPT_TIMER_ID   1
+#define PRTIMx          _PRTIM(CAPT_TIMER_ID)
+#define CAPTURE_ISR     _TCAPT_VECT(CAPT_TIMER_ID)
+#define OFLO_ISR        _TOVF_VECT(CAPT_TIMER_ID)
+
+#define TCCRAx          _TCCRA(CAPT_TIMER_ID)
+#define TCCRBx          _TCCRB(CAPT_TIMER_ID)
+#define TIMSKx          _TIMSK(CAPT_TIMER_ID)
+#define TIFRx           _TIFR(CAPT_TIMER_ID)
+#define TCNTx           _TCNT(CAPT_TIMER_ID)
+#define ICRx            _ICR(CAPT_TIMER_ID)
+#define ICIEx           _ICIE(CAPT_TIMER_ID)
+#define TOIEx           _TOIE(CAPT_TIMER_ID)
+#define ICFx            _ICF(CAPT_TIMER_ID)
+#define TOVx            _TOV(CAPT_TIMER_ID)
+
+#define RISING_ICES     _ICES(CAPT_TIMER_ID)
+
+#define CAPTURE_CLOCK   _PIN_MASK(_CS0(CAPT_TIMER_ID))  // clk I/O /1
+
+#if defined(COMPARATOR_HYSTERESIS) || defined(TOGGLE_EDGE)
+#define CAPTURE_TOGGLE
+#endif
+
+#ifdef RISING_EDGE
+#define CAPTURE_START   _PIN_MASK(RISING_ICES)
+#else
+#define CAPTURE_START   0
+#endif
+
+//
+// The + input is the upper threshold while waiting for the signal to rise
+//   (ACO falling), and the lower while waiting for it to fall (ACO rising).
+//
+#ifdef COMPARATOR_AIN0_UPPER
+#define SELECT_UPPER    _CLR_BIT(ACSR,ACBG)
+#define SELECT_LOWER    _SET_BIT(ACSR,ACBG)
+#else
+#define SELECT_UPPER    _SET_BIT(ACSR,ACBG)
+#define SELECT_LOWER    _CLR_BIT(ACSR,ACBG)
+#endif
+
+#if defined(_AVR_IOM1284P_H_) || defined(_AVR_IOM2560_H_)
+#define CPUPRR          PRR0
+#else
+#define CPUPRR          PRR
+#endif
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -95,15 +174,219 @@ bool ComparatorHit;
 //
 void ComparatorInit(void) {
 
+    memset((void *) &Comparator,0,sizeof(Comparator));
+
     _CLR_BIT(PRR,PRADC);            // Powerup the A/D (includes the comparator)
 
+#ifndef COMPARATOR_CAPTURE
     //
     // Setup the comparator to interrupt based on selected edge
     //
     _CLR_BIT(ADCSRB,ACME);
     ACSR = BANDGAP | _PIN_MASK(ACIE) | T1CAPTURE | EDGE;
+#else
+    //
+    // Setup the comparator to feed the input capture, with no interrupt of its
+    //   own. Timer1 runs free at full clock speed.
+    //
+    _CLR_BIT(ADCSRB,ACME);
+    ACSR = BANDGAP | T1CAPTURE;
+
+    _CLR_BIT(CPUPRR,PRTIMx);        // Powerup the clock
+
+    TCCRAx = 0;                     // Normal counter
+    TCCRBx = CAPTURE_CLOCK | CAPTURE_START;
+    TCNTx  = 0;
+
+#ifdef COMPARATOR_HYSTERESIS
+    //
+    // Start on the upper threshold. If the signal is already above it (ACO
+    //   low), go to the lower threshold and wait for the signal to fall.
+    //
+    SELECT_UPPER;
+    if( _BIT_OFF(ACSR,ACO) ) {
+        SELECT_LOWER;
+        _SET_BIT(TCCRBx,RISING_ICES);
+        }
+    else
+        _CLR_BIT(TCCRBx,RISING_ICES);
+#endif
+
+    TIFRx  = _PIN_MASK(ICFx) | _PIN_MASK(TOVx);     // Clear stale flags
+    TIMSKx = _PIN_MASK(ICIEx) | _PIN_MASK(TOIEx);   // Allow interrupts
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ComparatorGetCount - Return events since last ComparatorGetCount()
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint32_t ComparatorGetCount(void) {
+    uint8_t  SaveSREG = SREG;
+    uint32_t Count;
+
+    cli();
+    Count = Comparator.Count;
+    Comparator.Count = 0;
+    SREG  = SaveSREG;
+
+    return Count;
+    }
+
+#ifdef COMPARATOR_CAPTURE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ComparatorGetStats - Return trip timing since last ComparatorGetStats()
+//
+// Inputs:      Ptr to stats to fill in
+//
+// Outputs:     None.
+//
+void ComparatorGetStats(COMPARATOR_STATS *Stats) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    uint32_t PeriodSum = Comparator.PeriodSum;
+    uint16_t Periods   = Comparator.Periods;
+
+    Stats->PeriodMin = Comparator.PeriodMin;
+    Stats->PeriodMax = Comparator.PeriodMax;
+    Stats->Trips     = Comparator.Trips;
+
+    Comparator.PeriodSum = 0;
+    Comparator.PeriodMax = 0;
+    Comparator.Periods   = 0;
+    Comparator.Trips     = 0;
+    SREG = SaveSREG;
+
+    if( Periods == 0 ) {
+        Stats->Period    = 0;
+        Stats->PeriodMin = 0;
+        Stats->PeriodMax = 0;
+        return;
+        }
+
+    Stats->Period = (PeriodSum + Periods/2)/Periods;
     }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ComparatorGetTime - Return current timestamp
+//
+// If the timer overflows during the read, the overflow ISR changes TimerExt and
+//   the read is done again.
+//
+// Inputs:      None.
+//
+// Outputs:     Current 32-bit timer count
+//
+uint32_t ComparatorGetTime(void) {
+    uint16_t Ext;
+    uint16_t Count;
+
+    do {
+        Ext   = Comparator.TimerExt;
+        Count = TCNTx;
+        } while( Ext != Comparator.TimerExt );
+
+    return ((uint32_t) Ext << 16) | Count;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMERx_CAPT_vect - Comparator trip captured
+//
+// The overflow flag is checked as in Capture.c, in case an overflow just
+//   before the trip hasn't been serviced yet.
+//
+// With hysteresis the reference is switched before the capture flag is
+//   cleared, so any glitch from the switch is thrown away.
+//
+// Runs with interrupts off until the user's function is called.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(CAPTURE_ISR) {
+    uint16_t Count  = ICRx;
+    uint16_t Ext    = Comparator.TimerExt;
+    bool     Rising = _BIT_ON(TCCRBx,RISING_ICES);
+
+    if( _BIT_ON(TIFRx,TOVx) && Count < 0x8000 )
+        Ext++;
+
+#ifdef COMPARATOR_HYSTERESIS
+    if( Rising ) SELECT_UPPER       // Signal fell below lower threshold
+    else         SELECT_LOWER       // Signal rose above upper threshold
+#endif
+
+#ifdef CAPTURE_TOGGLE
+    TCCRBx ^= _PIN_MASK(RISING_ICES);
+#endif
+    TIFRx   = _PIN_MASK(ICFx);
+
+    //
+    // Stats are kept between trips in the same direction, one input cycle
+    //
+    uint32_t Time = ((uint32_t) Ext << 16) | Count;
+
+    if( Comparator.HaveLast[Rising] ) {
+        uint32_t Period = Time - Comparator.Last[Rising];
+
+        Comparator.PeriodSum += Period;
+
+        if( Comparator.Periods == 0 || Period < Comparator.PeriodMin )
+            Comparator.PeriodMin = Period;
+
+        if( Period > Comparator.PeriodMax )
+            Comparator.PeriodMax = Period;
+
+        if( Comparator.Periods < 0xFFFF )
+            Comparator.Periods++;
+        }
+
+    Comparator.Last    [Rising] = Time;
+    Comparator.HaveLast[Rising] = true;
+
+    if( Comparator.Trips < 0xFFFF )
+        Comparator.Trips++;
+    Comparator.Count++;
+
+    //
+    // Call the user's function
+    //
+#ifdef CALL_ComparatorISR
+    sei();
+    ComparatorISR(Time,Rising);
+#else
+    ComparatorHit = true;
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMERx_OVF_vect - Overflow timer count
+//
+// Just increment the extended word, making an equivalent 32-bit timer
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(OFLO_ISR) { Comparator.TimerExt++; }
+
+#else   // COMPARATOR_CAPTURE
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -115,6 +398,8 @@ void ComparatorInit(void) {
 //
 ISR(ANALOG_COMP_vect,ISR_NOBLOCK) {
 
+    Comparator.Count++;
+
     //
     // Call the user's function
     //
@@ -124,3 +409,5 @@ ISR(ANALOG_COMP_vect,ISR_NOBLOCK) {
     ComparatorHit = true;
 #endif
     }
+
+#endif  // COMPARATOR_CAPTURE
@@ -16,6 +16,8 @@
 //      ...Choose an edge (RISING/FALLING?TOGGLE)
 //      ...Choose bandgap or AIN0
 //      ...Choose whether to trigger input capture
+//      ...Choose capture mode             (Default: Off)
+//      ...Choose hysteresis               (Default: Off)
 //      ...Choose Polled or interrupt mode (Default: Interrupt)
 //
 //      //////////////////////////////////////
@@ -48,12 +50,55 @@
 //          sleep_cpu();
 //          }
 //
+//      //////////////////////////////////////
+//      //
+//      // Capture mode
+//      //
+//      void ComparatorISR(uint32_t Time,bool Rising) {  // Called at event
+//          ...Time is the Timer1 timestamp of the trip
+//          }
+//
+//      ComparatorInit();                   // Called once at startup
+//          :
+//
+//      ComparatorGetStats(&Stats);         // Trip timing since last call
+//
 //  DESCRIPTION
 //
 //      Comparator processing
 //
 //      Setup the comparator, then process hits
 //
+//      In capture mode (#define COMPARATOR_CAPTURE) the comparator output is
+//        routed to the Timer1 input capture unit (ACIC), and Timer1 runs free
+//        at the full CPU clock, extended to 32 bits. Each trip is timestamped
+//        by the hardware, so there is no jitter from interrupt latency: at 16
+//        MHz the timing is good to 62.5 nS. This gives precise zero-crossing
+//        and threshold timing.
+//
+//      ComparatorGetStats() returns the number of trips and the average,
+//        shortest and longest time between trips in the same direction (ie -
+//        one cycle of the input), then starts over.
+//
+//      Hysteresis (#define COMPARATOR_HYSTERESIS, capture mode only) is done
+//        by switching the + input between AIN0 and the bandgap (1.1V) after
+//        each trip. Put the signal on AIN1 and a second threshold voltage on
+//        AIN0. The signal has to rise above the upper threshold to trip, then
+//        fall below the lower one to trip back, so noise on a slow signal
+//        doesn't cause a burst of trips.
+//
+//        Since the signal is on the - input, ACO falls when the signal rises
+//        above the upper threshold, and rises when it falls below the lower.
+//
+//  NOTES
+//
+//      Capture mode uses Timer1 exclusively: it can't be used together with
+//        Capture.c, PWM.c, or FREQ_RECIPROCAL in Freq.h.
+//
+//      When switching the + input to the bandgap, the bandgap takes some time
+//        to turn on unless something else (the BOD or ADC) is keeping it on.
+//        Check the datasheet for your part.
+//
 //  EXAMPLE1
 //
 //      //
@@ -62,7 +107,7 @@
 //      static  TIME_T  ReportTimer;    // Timer for periodic output
 //      static  int     Count;          // Previous count
 //
-//      void TimerBISR {
+//      void TimerISR {
 //          if( --ReportTimer > 0 )     // Time to report count?
 //              return;                 // Nope - return
 //
@@ -78,7 +123,7 @@
 //          }
 //
 //      ReportTimer = SECONDS(60);      // Initialize the ReportTimer
-//      InitTimerB();                   // Start the Timer
+//      TimerInit();                    // Start the Timer
 //      InitCounter();                  // Initialize the Counter
 //
 //      sei();                          // Enable interrupts
@@ -115,6 +160,7 @@
 #ifndef COMPARATOR_H
 #define COMPARATOR_H
 
+#include <stdint.h>
 #include <stdbool.h>
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -132,10 +178,32 @@
 #define USE_BANDGAP
 
 //
-// Uncomment this next to cause the event to trigger a T1 input capture
+// Uncomment this next to cause the event to trigger a T1 input capture, for use
+//   by other code. (COMPARATOR_CAPTURE, below, does this and the Timer1 setup.)
 //
 //#define USE_T1CAPTURE
 
+//
+// Capture mode depends on the next definition.
+//
+// Defined (ie - uncommented) means timestamp each event with the Timer1 input
+//   capture, see above. The edge is the edge of ACO, selected as above.
+//
+//#define COMPARATOR_CAPTURE
+
+//
+// Hysteresis depends on the next definition (capture mode only).
+//
+// Defined (ie - uncommented) means switch the + input between AIN0 and the
+//   bandgap after each trip, see above. Both edges are then captured, and
+//   the edge selection above is ignored.
+//
+// COMPARATOR_AIN0_UPPER defined means AIN0 is the upper threshold, and the
+//   bandgap the lower. Commented out means the reverse.
+//
+//#define COMPARATOR_HYSTERESIS
+#define COMPARATOR_AIN0_UPPER
+
 //
 // Polled mode/ISR mode depends on the next definitions.
 //
@@ -144,6 +212,27 @@
 // 
 #define CALL_ComparatorISR
 
+//
+// End of user configurable options
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#if defined(COMPARATOR_HYSTERESIS) && !defined(COMPARATOR_CAPTURE)
+#error "Comparator: COMPARATOR_HYSTERESIS needs COMPARATOR_CAPTURE"
+#endif
+
+typedef struct {
+    uint32_t    Period;                             // Average time between like trips, CPU cycles
+    uint32_t    PeriodMin;                          // Shortest time between like trips
+    uint32_t    PeriodMax;                          // Longest  time between like trips
+    uint16_t    Trips;                              // Number of trips
+    } COMPARATOR_STATS;
+
+#define COMPARATOR_HZ   F_CPU                       // Timestamp counts per second
+
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -166,21 +255,56 @@ void ComparatorInit(void);
 //
 uint32_t ComparatorGetCount(void);
 
+#ifdef COMPARATOR_CAPTURE
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 //
-//  ComparatorISR  - User's comparator event handler
+// ComparatorGetStats - Return trip timing since last ComparatorGetStats()
+//
+// Inputs:      Ptr to stats to fill in
+//
+// Outputs:     None.
+//
+// NOTE: Only defined if COMPARATOR_CAPTURE is #defined, see above.
+//
+void ComparatorGetStats(COMPARATOR_STATS *Stats);
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// ComparatorGetTime - Return current timestamp
+//
+// For comparing with event timestamps, ie - to detect a signal that has stopped.
 //
 // Inputs:      None.
 //
+// Outputs:     Current 32-bit Timer1 count
+//
+// NOTE: Only defined if COMPARATOR_CAPTURE is #defined, see above.
+//
+uint32_t ComparatorGetTime(void);
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+//  ComparatorISR  - User's comparator event handler
+//
+// Inputs:      Timestamp of event        (capture mode only)
+//              TRUE if ACO rising edge   (capture mode only)
+//
 // Outputs:     None.
 //
 // NOTE: Only defined if CALL_ComparatorISR is #defined, see above.
 //
 #ifdef CALL_ComparatorISR
+#ifdef COMPARATOR_CAPTURE
+extern void ComparatorISR(uint32_t Time,bool Rising);
+#else
 extern void ComparatorISR(void);
+#endif
 #else
-extern bool ComparatorHit;
+extern volatile bool ComparatorHit;
 #endif
 
 #endif  // COMPARATOR_H - entire file
@@ -39,6 +39,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
+
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
@@ -46,26 +48,55 @@
 #include "TimerMacros.h"
 
 #ifndef CALL_CounterHWM_ISR
-extern volatile bool    CounterHWM;     // Set TRUE when reached
+volatile bool   CounterHWM;             // Set TRUE when reached
 #endif
 
 #ifndef CALL_CounterOFLO_ISR
-extern volatile bool    CounterOFLO;    // Set TRUE when reached
+volatile bool   CounterOFLO;            // Set TRUE when reached
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if COUNTER_ID == 1
+typedef uint16_t    COUNTER_HW_T;                   // Hardware counter width
+#define COUNTER_BITS    16
+#else
+typedef uint8_t     COUNTER_HW_T;
+#define COUNTER_BITS    8
 #endif
 
+#define COUNTER_SPAN    (1UL << COUNTER_BITS)       // Counts per overflow
+#define COUNTER_HALF    (1UL << (COUNTER_BITS-1))
+
+static volatile struct {
+    uint32_t    TimerExt;                           // Overflow count, upper bits of count
+    uint32_t    HWM;                                // High-water mark
+    uint32_t    PrevCount;                          // Count at last CounterUpdate()
+    uint32_t    Rate;                               // Counts in last tick
+    } Counter NOINIT;
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
 // Be sure that one (and only one) RISING/FALLING is defined
 //
+// The external clock is selected with all three CS bits for rising edges, or
+//   CS2 and CS1 for falling edges.
+//
 #ifdef RISING_EDGE
     #ifdef FALLING_EDGE
         #error "Both RISING and FALLING are defined."
         #endif
-    #define EDGE    0x01
+    #define EDGE    (_PIN_MASK(_CS2(COUNTER_ID)) | _PIN_MASK(_CS1(COUNTER_ID)) | _PIN_MASK(_CS0(COUNTER_ID)))
     #endif
 
 #ifdef FALLING_EDGE
-    #define EDGE    0x00
+    #define EDGE    (_PIN_MASK(_CS2(COUNTER_ID)) | _PIN_MASK(_CS1(COUNTER_ID)))
     #endif
 
 #ifndef EDGE
@@ -76,46 +107,132 @@ extern volatile bool    CounterOFLO;    // Set TRUE when reached
 //
 // Setup some port designations
 //
-#define TIMER_COMPA_ISR   _TCOMPA_VECT(TIMER_ID)
-#define TIMER_OFLO_ISR    _TOVF_VECT(TIMER_ID)
+#undef TIMER_ID                                     // Prevents typos in following
 
-#define TCNTx       _TCNT(TIMER_ID)
-#define TCCRAx      _TCCRA(TIMER_ID)
-#define TCCRBx      _TCCRB(TIMER_ID)
+#define TIMER_COMPA_ISR   _TCOMPA_VECT(COUNTER_ID)
+#define TIMER_OFLO_ISR    _TOVF_VECT(COUNTER_ID)
 
-#define OCRAx       _OCRA(TIMER_ID)
+#define TCNTx       _TCNT(COUNTER_ID)
+#define TCCRAx      _TCCRA(COUNTER_ID)
+#define TCCRBx      _TCCRB(COUNTER_ID)
 
+#define OCRAx       _OCRA(COUNTER_ID)
 
+#define PRTIMx      _PRTIM(COUNTER_ID)
 
+#define TIMSKx      _TIMSK(COUNTER_ID)
+#define TIFRx       _TIFR(COUNTER_ID)
+#define OCIEAx      _OCIEA(COUNTER_ID)
+#define TOIEx       _TOIE(COUNTER_ID)
+#define OCFAx       _OCFA(COUNTER_ID)
+#define TOVx        _TOV(COUNTER_ID)
 
+#if defined(_AVR_IOM1284P_H_)
+#define TIN_PORT    B                               // T0 == PB0, T1 == PB1
+#define TIN_PIN     (COUNTER_ID)
+#define CPUPRR      PRR0
+#elif defined(_AVR_IOM2560_H_)
+#define TIN_PORT    D                               // T0 == PD7, T1 == PD6
+#define TIN_PIN     (7-COUNTER_ID)
+#define CPUPRR      PRR0
+#else
+#define TIN_PORT    D                               // T0 == PD4, T1 == PD5
+#define TIN_PIN     (4+COUNTER_ID)
+#define CPUPRR      PRR
+#endif
 
-#define PRTIMx      _PRTIM(TIMER_ID)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterRead - Read the 32-bit count
+//
+// An overflow that happened before the hardware count was read, but hasn't
+//   been serviced yet, shows up as a small count with the overflow flag set.
+//
+// Must be called with interrupts off.
+//
+// Inputs:      None.
+//
+// Outputs:     32-bit count
+//
+static inline uint32_t CounterRead(void) {
+    uint32_t     Ext   = Counter.TimerExt;
+    COUNTER_HW_T Count = TCNTx;
 
+    if( _BIT_ON(TIFRx,TOVx) && Count < COUNTER_HALF )
+        Ext++;
 
-#define TIMSKx      _TIMSK(TIMER_ID)
-#define OCIEAx      _OCIEA(TIMER_ID)
+    return (Ext << COUNTER_BITS) | Count;
+    }
 
-/////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerInit - Initialize timer system
+// CounterInit - Initialize counter system
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
-void TimerInit(void) {
+void CounterInit(void) {
 
-    _CLR_BIT(PRR,PRTIMx);           // Powerup the clock
+    memset((void *) &Counter,0,sizeof(Counter));
+
+    _CLR_BIT(CPUPRR,PRTIMx);        // Powerup the clock
+
+    _CLR_BIT(_DDR(TIN_PORT),TIN_PIN);   // Counter input
 
     //
-    // Setup the timer as free running, with OCRA as top value
+    // Setup the timer as free running counter of external edges
     //
     TCCRAx = 0;                     // Normal counter mode
     TCCRBx = EDGE;                  // Count selected edge
-    OCRAx  = CLOCK_COUNT;           // And clock count for ticks
     TCNTx  = 0;
-    TIMSKx = _PIN_MASK(OCIEAx);     // Allow interrupts
+
+    TIFRx  = _PIN_MASK(OCFAx) | _PIN_MASK(TOVx);    // Clear stale flags
+    TIMSKx = _PIN_MASK(TOIEx);      // Overflows only, until a HWM is set
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterGetCount - Return events since CounterInit()
+//
+// Inputs:      None.
+//
+// Outputs:     32-bit count of events
+//
+uint32_t CounterGetCount(void) {
+    uint8_t  SaveSREG = SREG;
+    uint32_t Count;
+
+    cli();
+    Count = CounterRead();
+    SREG  = SaveSREG;
+
+    return Count;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterSetCount - Set the event count
+//
+// The rate isn't disturbed: the next CounterUpdate() counts from here.
+//
+// Inputs:      New count value
+//
+// Outputs:     None.
+//
+void CounterSetCount(uint32_t Count) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    TCNTx             = Count & (COUNTER_SPAN-1);
+    Counter.TimerExt  = Count >> COUNTER_BITS;
+    Counter.PrevCount = Count;
+    TIFRx             = _PIN_MASK(TOVx);        // Forget any pending overflow
+    SREG              = SaveSREG;
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -123,41 +240,104 @@ void TimerInit(void) {
 //
 // CounterSetHWM - Set the "high water mark"
 //
+// The compare register holds the low bits of the mark, so the compare ISR
+//   runs whenever the low bits of the count match.
+//
 // Inputs:      The HWM value to set
 //
 // Outputs:     None.
 //
-void CounterSetHWM(unsigned HWM) { OCRAx = HWM; }
+void CounterSetHWM(uint32_t HWM) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    Counter.HWM = HWM;
+    OCRAx       = HWM & (COUNTER_SPAN-1);
+    TIFRx       = _PIN_MASK(OCFAx);             // Clear stale match
+    _SET_BIT(TIMSKx,OCIEAx);
+    SREG        = SaveSREG;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterClearHWM - Remove the "high water mark"
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void CounterClearHWM(void) { _CLR_BIT(TIMSKx,OCIEAx); }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// CounterGetCount - Return timer count
+// CounterUpdate - Update count rate
 //
 // Inputs:      None.
 //
-// Outputs:     The value specified.
+// Outputs:     None.
 //
-TIME_T CounterGetCount(void) { return(TCNTx); }
+void CounterUpdate(void) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    uint32_t Count = CounterRead();
+
+    Counter.Rate      = Count - Counter.PrevCount;
+    Counter.PrevCount = Count;
+    SREG              = SaveSREG;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterGetRate - Return counts in the last timer tick
+//
+// Inputs:      None.
+//
+// Outputs:     Counts between the last two calls to CounterUpdate()
+//
+uint32_t CounterGetRate(void) {
+    uint8_t  SaveSREG = SREG;
+    uint32_t Rate;
+
+    cli();
+    Rate = Counter.Rate;
+    SREG = SaveSREG;
+
+    return Rate;
+    }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // TIMERx_COMPA_vect - Timer reaches COMPA
 //
-// This defines the high-water mark of the timer
+// The low bits of the count match the high-water mark. If the whole count is
+//   at (or just past) the mark, turn off the compare and call the user.
+//
+// Runs with interrupts off until the user's function is called, so the
+//   overflow ISR can't change TimerExt in the middle of the read.
 //
 // Inputs:      None. (ISR)
 //
 // Outputs:     None.
 //
-ISR(TIMER_COMPA_ISR,ISR_NOBLOCK) {
+ISR(TIMER_COMPA_ISR) {
+    uint32_t Count = CounterRead();
+
+    if( Count - Counter.HWM >= COUNTER_SPAN )
+        return;                     // Not there yet
+
+    _CLR_BIT(TIMSKx,OCIEAx);        // Mark fires once
 
     //
     // Call the user's function
     //
 #ifdef CALL_CounterHWM_ISR
-    CounterHWM_ISR();
+    sei();
+    CounterHWM_ISR(Count);
 #else
     CounterHWM = true;
 #endif
@@ -168,16 +348,22 @@ ISR(TIMER_COMPA_ISR,ISR_NOBLOCK) {
 //
 // TIMERx_OFLO_vect - Timer overflows
 //
+// Extend the count. The user is only told when the whole 32-bit count wraps.
+//
 // Inputs:      None. (ISR)
 //
 // Outputs:     None.
 //
-ISR(TIMER_OFLO_ISR,ISR_NOBLOCK) {
+ISR(TIMER_OFLO_ISR) {
+
+    if( (++Counter.TimerExt << COUNTER_BITS) != 0 )
+        return;
 
     //
     // Call the user's function
     //
 #ifdef CALL_CounterOFLO_ISR
+    sei();
     CounterOFLO_ISR();
 #else
     CounterOFLO = true;
@@ -31,27 +31,21 @@
 //
 //          CounterHWM = false;             // Reset flag
 //              :           :               // Process High-Water event
-//
-//          while( !CounterOFLO );          // Wait for overflow
-//
-//          CounterOFLO = false;            // Reset flag
-//              :           :               // Process overflow
-//
 //          }
 //
 //      //////////////////////////////////////
 //      //
 //      // Interrupt mode
 //      //
-//      void CounterHWM_ISR(void) {         // Called at high-water
+//      void CounterHWM_ISR(uint32_t Count) {   // Called at high-water
 //          ...process high-water event
+//          CounterSetHWM(Count+200);       // ...and maybe set the next one
 //          }
 //
-//      void CounterOFLO_ISR(void) {        // Called at overflow
+//      void CounterOFLO_ISR(void) {        // Called when 32-bit count wraps
 //          ...process overflow event
 //          }
 //
-//
 //      CounterInit();                      // Called once at startup
 //      CounterSetHWM(200);                 // Set high-water mark
 //          :
@@ -65,8 +59,15 @@
 //      // General - Counter management
 //      //
 //      CurrentCount = CounterGetCount();   // Get current count
-//      TimerSetCount(0);                   // Reset count to zero
+//      CounterSetCount(0);                 // Reset count to zero
 //      CounterSetHWM(200);                 // Set high-water mark
+//      CounterClearHWM();                  // No more high-water events
+//
+//      void TimerISR(void) {               // Once per timer tick
+//          CounterUpdate();                // Update count rate
+//          }
+//
+//      Rate = CounterGetRate();            // Counts in last tick
 //
 //  DESCRIPTION
 //
@@ -77,30 +78,44 @@
 //      This code configures a timer as an external event counter, with optional
 //        high-water mark. The interface is in the model of a counter device, which
 //        may be polled on an "interrupt flag", or setup as an "ISR callback" when
-//        the high water mark is reached, or when the timer overflows.
+//        the high water mark is reached, or when the count overflows.
+//
+//      The hardware counter is extended to 32 bits by counting overflows in an
+//        ISR. CounterGetCount() reads both with interrupts off, and an overflow
+//        that has happened but hasn't been serviced yet is picked up from the
+//        overflow flag, so the count never goes backwards or jumps by 256.
+//
+//      The high-water mark is 32 bits. The compare register holds the low bits
+//        of the mark, and the compare ISR checks the full count each time the
+//        low bits match (once per 256 counts on Timer0). The mark fires once,
+//        when the count reaches it; set it again for the next event.
+//
+//      CounterUpdate(), called once per timer tick, saves the counts in that
+//        tick as the count rate. At 25 ticks per second, COUNTER_PER_SEC()
+//        converts the rate to counts per second.
 //
 //  EXAMPLE1
 //
 //      //
 //      // Log the number of events every minute
 //      //
-//      static  TIME_T  ReportTimer;    // Timer for periodic output
-//      static  uint8_t PrevCount;      // Previous count
+//      static  TIME_T   ReportTimer;   // Timer for periodic output
+//      static  uint32_t PrevCount;     // Previous count
 //
-//      void TimerBISR {
+//      void TimerISR {
 //          if( --ReportTimer > 0 )     // Time to report count?
 //              return;                 // Nope - return
 //
 //          ReportTimer = SECONDS(60)   // Reset timer
 //
-//          uint8_t NewCount = Timer.GetCount();
-//          PrintD(NewCount-PrevCount,3);   // => printf("%3d"
+//          uint32_t NewCount = CounterGetCount();
+//          PrintLD(NewCount-PrevCount,3);  // => printf("%3ld"
 //          PrevCount = NewCount;
 //          }
 //
 //      ReportTimer = SECONDS(60);      // Initialize the ReportTimer
-//      InitTimerB();                   // Start the Timer
-//      InitCounter();                  // Initialize the Counter
+//      TimerInit();                    // Start the Timer
+//      CounterInit();                  // Initialize the Counter
 //
 //      sei();                          // Enable interrupts
 //
@@ -115,25 +130,26 @@
 //      //
 //      static  TIME_T  AlarmTimer;     // Timer for alarm
 //
-//      void TimerBISR {
-//          if( --ReportTimer > 0 )     // Time to reset alarm?
+//      void TimerISR {
+//          if( --AlarmTimer > 0 )      // Time to reset alarm?
 //              return;                 // Nope - return
 //
-//          ReportTimer = SECONDS(60)   // Reset timer
+//          AlarmTimer = SECONDS(60)    // Reset timer
 //
 //          CounterSetCount(0);         // Reset alarm counter
+//          CounterSetHWM(200);         // ...and rearm the alarm
 //          }
 //
-//      void CounterHWM_ISR(void) {
-//          void PrintString("200 Events/Min Exceeded!\r\n");
+//      void CounterHWM_ISR(uint32_t Count) {
+//          PrintString("200 Events/Min Exceeded!\r\n");
 //          }
 //
 //      //
 //      // In main.c
 //      //
 //      AlarmTimer = SECONDS(60);       // Initialize the AlarmTimer
-//      InitTimerB();                   // Start the Timer
-//      InitCounter();                  // Initialize the Counter
+//      TimerInit();                    // Start the Timer
+//      CounterInit();                  // Initialize the Counter
 //      CounterSetHWM(200);             // Set the alarm mark
 //
 //      sei();                          // Enable interrupts
@@ -147,6 +163,13 @@
 //      The user's CounterXXX_ISR() function is called in interrupt context of
 //        the timer (but with interrupts enabled).
 //
+//      The input is T0 (PD4) for Timer0 and T1 (PD5) for Timer1 on the 328. The
+//        hardware counts up to about F_CPU/2.5 (6.4 MHz at 16 MHz).
+//
+//      On Timer0 the overflow ISR runs every 256 counts, and the compare ISR
+//        once per 256 counts while a high-water mark is set. Timer1 cuts both
+//        to once per 65536 counts, for very high count rates.
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  MIT LICENSE
@@ -174,13 +197,18 @@
 #ifndef COUNTER_H
 #define COUNTER_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "Timer.h"
 
-/////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Specify a timer to use
 //
+// Timer0 and Timer1 have external clock inputs (T0 and T1).
+//
 // If RISING_EDGEs are to be counted, uncomment the RISING_EDGE definition.
 //   Otherwise, uncomment the FALLING_EDGE definition.
 //
@@ -193,17 +221,29 @@
 // Polled mode/ISR mode depends on the next definitions.
 //
 // Defined (ie - uncommented) means call the ISR. Undefined (commented out)
-//   means don't.
+//   means set the flag instead.
 // 
 // If you only need the CounterGetCount(), use polled mode & comment this out.
 //
-//
-
 #define CALL_CounterHWM_ISR
 #define CALL_CounterOFLO_ISR
 
-/////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#if COUNTER_ID != 0 && COUNTER_ID != 1
+#error "Counter: COUNTER_ID must be 0 or 1, the timers with an external clock input"
+#endif
+
+#define COUNTER_PER_SEC(_r_)    ((_r_)*TICKS_PER_SEC)   // Rate per tick to per second
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // CounterInit - Initialize counter system
 //
@@ -213,31 +253,83 @@
 //
 void CounterInit(void);
 
-/////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // CounterGetCount - Return events since CounterInit()
 //
 // Inputs:      None.
 //
-// Outputs:     The value specified.
+// Outputs:     32-bit count of events
 //
-TIME_T CounterGetCount(void);
+uint32_t CounterGetCount(void);
 
-/////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//  CounterHWM_ISR  - User's "High Water Mark" update routine
-//  CounterOFLO_ISR - User's "Overflow" update routine
+// CounterSetCount - Set the event count
+//
+// Inputs:      New count value
+//
+// Outputs:     None.
+//
+void CounterSetCount(uint32_t Count);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterSetHWM   - Set the "high water mark"
+// CounterClearHWM - Remove the "high water mark"
+//
+// The mark fires once, when the count reaches it. It must be ahead of the
+//   current count: a mark the count has already passed fires only after the
+//   count wraps around.
+//
+// Inputs:      The HWM value to set
+//
+// Outputs:     None.
+//
+void CounterSetHWM(uint32_t HWM);
+void CounterClearHWM(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterUpdate - Update count rate
+//
+// Call once per timer tick.
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
+void CounterUpdate(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CounterGetRate - Return counts in the last timer tick
+//
+// Inputs:      None.
+//
+// Outputs:     Counts between the last two calls to CounterUpdate()
+//
+uint32_t CounterGetRate(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  CounterHWM_ISR  - User's "High Water Mark" update routine
+//  CounterOFLO_ISR - User's "Overflow" update routine, when the 32-bit count wraps
+//
+// Inputs:      Count when the ISR ran (CounterHWM_ISR only)
+//
+// Outputs:     None.
+//
 // NOTE: Only defined if CALL_CounterXXX_ISR is #defined, see above.
 //
 #ifdef CALL_CounterHWM_ISR
-void CounterHWM_ISR(void);
+void CounterHWM_ISR(uint32_t Count);
 #else 
 extern volatile bool    CounterHWM;     // Set TRUE when reached
 #endif
@@ -35,7 +35,13 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
 
 #include "PortMacros.h"
 
@@ -49,10 +55,242 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//
+// One journal slot. Slots are a fixed size so that records written by older
+//   versions of EEPROM_T can still be found and migrated. The record is the
+//   header, Len bytes of EEPROM_T, then the CRC of all of these. The CRC is
+//   written last, and the rest of the slot is unused.
+//
+#define REC_HDR_SIZE    3                           // Seq + Len
+#define REC_CRC_SIZE    2
+#define REC_DATA_MAX    (EEPROM_SLOT_SIZE-REC_HDR_SIZE-REC_CRC_SIZE)
+
+typedef struct {
+    uint16_t    Seq;                                // Sequence number of record
+    uint8_t     Len;                                // Bytes of data in record
+    uint8_t     Data[REC_DATA_MAX+REC_CRC_SIZE];    // EEPROM_T followed by CRC
+    } EEPROM_RECORD;
+
+#define NUM_SLOTS       ((EEPROM_JOURNAL_END-EEPROM_JOURNAL_START)/EEPROM_SLOT_SIZE)
+#define SLOT_OFFSET(_s_) (EEPROM_JOURNAL_START + (_s_)*EEPROM_SLOT_SIZE)
+#define SLOT_ADDR(_s_)  ((uint8_t *) (uintptr_t) SLOT_OFFSET(_s_))
+
+#define SEQ_ERASED      0xFFFF                      // Seq of erased EEPROM, never written
+#define CRC_INIT        0xFFFF
+
+_Static_assert(sizeof(EEPROM_RECORD) == EEPROM_SLOT_SIZE && EEPROM_SLOT_SIZE <= 256,
+               "EEPROM_SLOT_SIZE must be 256 or less");
+_Static_assert(sizeof(EEPROM_T) <= REC_DATA_MAX,"EEPROM_T doesn't fit in EEPROM_SLOT_SIZE");
+_Static_assert(NUM_SLOTS >= 2,"EEPROM journal needs at least 2 slots: make EEPROM_SLOT_SIZE smaller or the journal larger");
+
 EEPROM_T    EEPROM NOINIT;
 
 PROGMEM EEPROM_T EEPROMDefaults = EEPROM_DEFAULTS;
 
+//
+// Migration steps, in order of the version they upgrade from
+//
+static PROGMEM EEPROM_STEP EEPROMSteps[] = EEPROM_MIGRATIONS;
+
+//
+// Size of EEPROM_T at address 0 for each version, from before the journal
+//
+static PROGMEM uint8_t EEPROMLegacySizes[EEPROM_CURR_VERSION+1] = EEPROM_LEGACY_SIZES;
+
+static void EEPROMNextByte(void);
+
+static struct {
+    uint16_t    Slot;                               // Slot of newest record
+    uint16_t    Seq;                                // Seq  of newest record
+    EEPROM_RECORD Record;                           // Record being written
+    } Journal NOINIT;
+
+#ifndef CALL_EEPROMDone_ISR
+volatile bool   EEPROMDone;                         // Set TRUE when queue is written
+#endif
+
+//
+// Write queue. Each entry is a block of RAM to be copied to EEPROM.
+//
+#define QUEUE_MASK      (EEPROM_QUEUE_SIZE-1)
+
+_Static_assert((EEPROM_QUEUE_SIZE & QUEUE_MASK) == 0 && EEPROM_QUEUE_SIZE <= 128,
+               "EEPROM_QUEUE_SIZE must be a power of 2, 128 or less");
+
+typedef struct {
+    const uint8_t  *Src;                            // Data to write
+    uint16_t        Addr;                           // EEPROM address to write
+    uint16_t        Len;                            // Number of bytes
+    } EEPROM_BLOCK;
+
+static volatile struct {
+    EEPROM_BLOCK    Blocks[EEPROM_QUEUE_SIZE];
+    uint8_t         Head;                           // Next entry to fill
+    uint8_t         Tail;                           // Entry being written
+    uint16_t        Index;                          // Next byte of Blocks[Tail]
+    bool            Busy;                           // TRUE if writes in progress
+    } Queue NOINIT;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMCheckSlot - Check a journal slot for a valid record
+//
+// The CRC is calculated directly from EEPROM, so no RAM buffer is needed.
+//
+// Inputs:      Slot to check
+//              Ptr to returned sequence number
+//
+// Outputs:     TRUE  if slot holds a valid record (and *Seq is set)
+//              FALSE if slot is erased or damaged
+//
+static bool EEPROMCheckSlot(uint16_t Slot,uint16_t *Seq) {
+    uint8_t *Addr = SLOT_ADDR(Slot);
+    uint16_t CRC  = CRC_INIT;
+
+    eeprom_read_block(Seq,Addr+offsetof(EEPROM_RECORD,Seq),sizeof(*Seq));
+
+    uint8_t Len = eeprom_read_byte(Addr+offsetof(EEPROM_RECORD,Len));
+
+    if( *Seq == SEQ_ERASED || Len == 0 || Len > REC_DATA_MAX )
+        return false;
+
+    for( uint8_t i=0; i<REC_HDR_SIZE+Len; i++ )
+        CRC = _crc_ccitt_update(CRC,eeprom_read_byte(Addr+i));
+
+    return CRC == eeprom_read_word((uint16_t *) (Addr+REC_HDR_SIZE+Len));
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMMigrate - Upgrade a record from an older version
+//
+// Each version from the record's up to EEPROM_CURR_VERSION has its steps applied in
+//   table order, then the version number is bumped. A version with no steps (ie -
+//   same layout, new defaults) just gets the new version number.
+//
+// Inputs:      Ptr to record data, with room for REC_DATA_MAX bytes
+//              Ptr to length of record data, updated
+//
+// Outputs:     TRUE  if record is now EEPROM_CURR_VERSION and sizeof(EEPROM_T)
+//              FALSE if it can't be migrated (newer version, or bad steps)
+//
+static bool EEPROMMigrate(uint8_t *Data,uint8_t *Len) {
+    uint8_t Version = Data[0];
+
+    if( Version > EEPROM_CURR_VERSION )
+        return false;                               // Can't downgrade
+
+    for( ; Version < EEPROM_CURR_VERSION; Data[0] = ++Version ) {
+
+        for( const EEPROM_STEP *Ptr=EEPROMSteps; Ptr<EEPROMSteps+NUMOF(EEPROMSteps); Ptr++ ) {
+            EEPROM_STEP Step;
+
+            memcpy_P(&Step,Ptr,sizeof(Step));
+
+            if( Step.Version != Version )
+                continue;
+
+            //
+            // Check the step stays within the data, so that a bad table can't
+            //   scribble on RAM.
+            //
+            uint16_t End = Step.Offset + Step.Len;
+
+            switch( Step.Op ) {
+
+                case EEPROM_OP_INSERT:
+                    if( Step.Offset > *Len || *Len + Step.Len > REC_DATA_MAX )
+                        return false;
+                    memmove(Data+End,Data+Step.Offset,*Len-Step.Offset);
+                    memset (Data+Step.Offset,Step.Arg,Step.Len);
+                    *Len += Step.Len;
+                    break;
+
+                case EEPROM_OP_DELETE:
+                    if( End > *Len )
+                        return false;
+                    memmove(Data+Step.Offset,Data+End,*Len-End);
+                    *Len -= Step.Len;
+                    break;
+
+                case EEPROM_OP_FILL:
+                    if( End > *Len )
+                        return false;
+                    memset(Data+Step.Offset,Step.Arg,Step.Len);
+                    break;
+
+                case EEPROM_OP_DEFAULT:
+                    if( End > *Len || End > sizeof(EEPROM_T) )
+                        return false;
+                    memcpy_P(Data+Step.Offset,((const uint8_t *) &EEPROMDefaults)+Step.Offset,Step.Len);
+                    break;
+
+                case EEPROM_OP_MOVE:
+                    if( End > *Len || Step.Arg + Step.Len > *Len )
+                        return false;
+                    memmove(Data+Step.Offset,Data+Step.Arg,Step.Len);
+                    break;
+
+                default:
+                    return false;
+                }
+            }
+        }
+
+    return *Len == sizeof(EEPROM_T);
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMLegacy - Import EEPROM_T stored raw at address 0, from before the journal
+//
+// The first record goes to the first slot clear of the old block, so the old block
+//   survives a reset during the import. That slot may hold a partly written
+//   record from such a reset, but any slot past it means the journal has been in
+//   use, and address 0 holds journal data rather than the old block.
+//
+// Inputs:      Number of journal slots in use (up to the highest one written)
+//
+// Outputs:     TRUE  if old data imported into EEPROM, and written to journal
+//              FALSE if no old data, or it can't be migrated
+//
+static bool EEPROMLegacy(uint16_t Used) {
+    EEPROM_RECORD *Record = &Journal.Record;
+    uint8_t  Version = eeprom_read_byte(0);
+    uint8_t  Len;
+    uint16_t Slot    = 0;
+
+    if( Version > EEPROM_CURR_VERSION )
+        return false;                               // Erased, or newer version
+
+    Len = pgm_read_byte(&EEPROMLegacySizes[Version]);
+    if( Len == 0 || Len > REC_DATA_MAX )
+        return false;
+
+    if( EEPROM_JOURNAL_START < Len )
+        Slot = (Len-1-EEPROM_JOURNAL_START)/EEPROM_SLOT_SIZE + 1;
+
+    if( Used > Slot+1 )
+        return false;
+
+    eeprom_read_block(Record->Data,0,Len);
+    Record->Len = Len;
+
+    if( !EEPROMMigrate(Record->Data,&Record->Len) )
+        return false;
+
+    memcpy(&EEPROM,Record->Data,sizeof(EEPROM));
+    Journal.Slot = Slot == 0 ? NUM_SLOTS-1 : Slot-1;
+    EEPROMWrite();
+    return true;
+    }
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -63,17 +301,65 @@ PROGMEM EEPROM_T EEPROMDefaults = EEPROM_DEFAULTS;
 // Outputs:     None.
 //
 void EEPROMInit(void) {
+    bool     Found = false;
+    uint16_t Used  = 0;
 
-    eeprom_read_block(&EEPROM,0,sizeof(EEPROM));
+    _CLR_BIT(EECR,EERIE);
+    memset((void *) &Queue,0,sizeof(Queue));
 
     //
-    // If uninitialized, or if version mismatch (we're the newer version), initialize
-    //   with defaults
+    // Find the newest valid record. Sequence numbers wrap, so compare with
+    //   serial arithmetic: all valid records are within NUM_SLOTS of each other.
     //
-    if( EEPROM.Version != EEPROM_CURR_VERSION ) {
-        memcpy_P(&EEPROM,&EEPROMDefaults,sizeof(EEPROM));
-        EEPROMWrite();
+    for( uint16_t Slot=0; Slot<NUM_SLOTS; Slot++ ) {
+        uint16_t Seq;
+        bool     Valid = EEPROMCheckSlot(Slot,&Seq);
+
+        if( Seq != SEQ_ERASED )
+            Used = Slot+1;
+
+        if( !Valid )
+            continue;
+
+        if( !Found || (int16_t) (Seq - Journal.Seq) > 0 ) {
+            Journal.Slot = Slot;
+            Journal.Seq  = Seq;
+            Found        = true;
+            }
+        }
+
+    if( !Found ) {
+        Journal.Slot = NUM_SLOTS-1;                 // First write goes to slot 0
+        Journal.Seq  = 0;
+        }
+
+    //
+    // Current version: use as is. Older version: migrate in the record buffer, and
+    //   save the upgraded record. If no record, import the data from before the
+    //   journal. If uninitialized, or it can't be migrated, initialize with defaults.
+    //
+    if( Found ) {
+        EEPROM_RECORD *Record = &Journal.Record;
+
+        eeprom_read_block(Record,SLOT_ADDR(Journal.Slot),REC_HDR_SIZE);
+        eeprom_read_block(Record->Data,SLOT_ADDR(Journal.Slot)+REC_HDR_SIZE,Record->Len);
+
+        if( Record->Data[0] == EEPROM_CURR_VERSION && Record->Len == sizeof(EEPROM) ) {
+            memcpy(&EEPROM,Record->Data,sizeof(EEPROM));
+            return;
+            }
+
+        if( EEPROMMigrate(Record->Data,&Record->Len) ) {
+            memcpy(&EEPROM,Record->Data,sizeof(EEPROM));
+            EEPROMWrite();
+            return;
+            }
         }
+    else if( EEPROMLegacy(Used) )
+        return;
+
+    memcpy_P(&EEPROM,&EEPROMDefaults,sizeof(EEPROM));
+    EEPROMWrite();
     }
 
 
@@ -82,11 +368,199 @@ void EEPROMInit(void) {
 //
 // EEPROMWrite - Write new EEPROM values from RAM
 //
+// The values are copied into a new journal record, and queued for writing. If the
+//   previous record is still being written, wait for it to finish first.
+//
 // Inputs:      None.
 //
 // Outputs:     None.
 //
 void EEPROMWrite(void) {
+    EEPROM_RECORD *Record = &Journal.Record;
+    uint16_t Slot = Journal.Slot + 1;
+    uint16_t Seq  = Journal.Seq  + 1;
+    uint16_t CRC  = CRC_INIT;
+
+    if( Slot >= NUM_SLOTS )
+        Slot = 0;
+
+    if( Seq == SEQ_ERASED )
+        Seq = 0;
+
+    EEPROMWait();                                   // Record buffer in use until written
+
+    Record->Seq = Seq;
+    Record->Len = sizeof(EEPROM);
+    memcpy(Record->Data,&EEPROM,sizeof(EEPROM));
+
+    for( uint8_t i=0; i<REC_HDR_SIZE+sizeof(EEPROM); i++ )
+        CRC = _crc_ccitt_update(CRC,((uint8_t *) Record)[i]);
+
+    Record->Data[sizeof(EEPROM)]   = CRC & 0xFF;    // Little endian, as eeprom_read_word()
+    Record->Data[sizeof(EEPROM)+1] = CRC >> 8;
+
+    //
+    // Bytes are written in address order, so the CRC at the end of the record goes
+    //   last and the record doesn't become valid until all of it is written. A reset
+    //   before then leaves the previous record as the newest.
+    //
+    EEPROMWriteBlock(Record,SLOT_OFFSET(Slot),REC_HDR_SIZE+sizeof(EEPROM)+REC_CRC_SIZE);
+
+    Journal.Slot = Slot;
+    Journal.Seq  = Seq;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMWriteBlock - Queue a block of RAM to be written to EEPROM
+//
+// Inputs:      Ptr to data to write (must remain unchanged until written)
+//              EEPROM address to write to
+//              Number of bytes to write
+//
+// Outputs:     TRUE  if block was queued
+//              FALSE if queue is full
+//
+bool EEPROMWriteBlock(const void *Src,uint16_t Addr,uint16_t Len) {
+
+    if( Len == 0 )
+        return true;
+
+    uint8_t SaveSREG = SREG;
+    cli();
+
+    if( (uint8_t) (Queue.Head - Queue.Tail) >= EEPROM_QUEUE_SIZE ) {
+        SREG = SaveSREG;
+        return false;
+        }
+
+    EEPROM_BLOCK *Block = (EEPROM_BLOCK *) &Queue.Blocks[Queue.Head & QUEUE_MASK];
+
+    Block->Src  = Src;
+    Block->Addr = Addr;
+    Block->Len  = Len;
+    Queue.Head++;
+    Queue.Busy  = true;
+
+    _SET_BIT(EECR,EERIE);                           // Start writing, or keep going
+
+    SREG = SaveSREG;
+    return true;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMBusy - Return TRUE if queued writes are in progress
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if writes still in progress
+//              FALSE if all writes are finished
+//
+bool EEPROMBusy(void) { return Queue.Busy; }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMWait - Wait for queued writes to finish
+//
+// If interrupts are off (ie - before sei() in main) the queue is written by polling.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void EEPROMWait(void) {
+
+    while( Queue.Busy ) {
+        if( _BIT_ON(SREG,SREG_I) || _BIT_ON(EECR,EEPE) )
+            continue;
+
+        EEPROMNextByte();
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMNextByte - Start writing the next changed byte in the queue
+//
+// Bytes that already hold the new value are skipped, saving the write time and
+//   the wear. Only EEPROM_MAX_SKIP are checked per call to bound the ISR time; the
+//   ready interrupt is still pending, so the ISR will be called again right away.
+//
+// A byte that only needs bits cleared is written without erasing, and a byte of 0xFF
+//   is only erased, each taking about half the time of a full erase and write.
+//
+// Must be called with interrupts off and EEPROM ready (EEPE clear).
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void EEPROMNextByte(void) {
+
+    for( uint8_t Skip=0; Skip<EEPROM_MAX_SKIP; Skip++ ) {
+
+        //
+        // Queue empty and last write finished - tell the user
+        //
+        if( Queue.Head == Queue.Tail ) {
+            _CLR_BIT(EECR,EERIE);
+            Queue.Busy = false;
+#ifdef CALL_EEPROMDone_ISR
+            EEPROMDone_ISR();
+#else
+            EEPROMDone = true;
+#endif
+            return;
+            }
+
+        EEPROM_BLOCK *Block = (EEPROM_BLOCK *) &Queue.Blocks[Queue.Tail & QUEUE_MASK];
+        uint16_t      Addr  = Block->Addr + Queue.Index;
+        uint8_t       New   = Block->Src[Queue.Index];
+
+        if( ++Queue.Index >= Block->Len ) {
+            Queue.Index = 0;
+            Queue.Tail++;
+            }
+
+        EEAR = Addr;
+        _SET_BIT(EECR,EERE);                        // Read takes effect immediately
+        uint8_t Old = EEDR;
+
+        if( Old == New )
+            continue;
+
+        EEDR = New;
+
+        if     ( New == 0xFF )          EECR = _BV(EERIE) | _BV(EEPM0);     // Erase only
+        else if( (Old & New) == New )   EECR = _BV(EERIE) | _BV(EEPM1);     // Write only
+        else                            EECR = _BV(EERIE);                  // Erase and write
+
+        _SET_BIT(EECR,EEMPE);                       // Must be within 4 cycles of each other
+        _SET_BIT(EECR,EEPE);
+        return;
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EE_READY_vect - EEPROM ready for next write
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(EE_READY_vect) {
 
-    eeprom_write_block(&EEPROM,0,sizeof(EEPROM));
+    EEPROMNextByte();
     }
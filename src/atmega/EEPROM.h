@@ -32,6 +32,81 @@
 //
 //  DESCRIPTION
 //
+//      Wear-leveled, CRC protected settings journal
+//
+//      EEPROMWrite() doesn't overwrite the previous settings. Each write appends
+//        a new record to the next slot of the journal, wrapping around at the
+//        end, so writes are spread evenly over the whole area and every cell
+//        sees only 1/Nth of the writes.
+//
+//      Each record holds a 16-bit sequence number, a copy of EEPROM_T, and a
+//        CRC of both. The CRC is written last, so a record only becomes valid
+//        once it is completely written.
+//
+//      EEPROMInit() scans the journal and loads the valid record with the
+//        highest sequence number (using serial arithmetic, so the number can
+//        wrap). If there is no valid record the defaults are loaded and written
+//        as a new record.
+//
+//      When EEPROM_CURR_VERSION is bumped, older records are migrated rather
+//        than thrown away, so settings and calibration survive a firmware
+//        update. EEPROM_MIGRATIONS lists the steps to upgrade from each older
+//        version: insert a field, delete a field, fill with a value or with its
+//        default, or move bytes. The steps are kept in flash, and applied in
+//        place in the record buffer at boot; the result is saved as a new
+//        record, with unchanged bytes skipped. Records from a newer version,
+//        or which don't end up sizeof(EEPROM_T) long, are replaced by the
+//        defaults.
+//
+//      A reset or brown-out in the middle of a write damages at most the slot
+//        being written, which holds the oldest record. The previous settings
+//        are still intact in their own slot and will be found at the next boot.
+//
+//  NOTES
+//
+//      Each record takes sizeof(EEPROM_T)+5 bytes in a slot of EEPROM_SLOT_SIZE.
+//        The slot size fixes the journal layout, so leave room for EEPROM_T to
+//        grow: changing it loses the stored settings. With a 1K EEPROM and
+//        32-byte slots there are 32 slots, and at least 2 are needed.
+//
+//      Boot time is mostly the journal scan: about 40 CPU cycles per byte read
+//        for the CRC, and erased slots are rejected after the first 3 bytes.
+//        For a 48-byte EEPROM_T in 64-byte slots, a full 1K journal is 16 x 51
+//        bytes, or about 2 ms at 16 MHz. Migration steps are a memmove() of at
+//        most a slot each, a few microseconds. These are cycle counts of the
+//        code, not measured on hardware.
+//
+//      Writes are done in the background by the EEPROM ready interrupt, so
+//        EEPROMWrite() returns right away instead of waiting about 3.3 ms per
+//        byte. The record is copied to a buffer first, so EEPROM can be changed
+//        again immediately. Bytes which already hold the new value are skipped,
+//        saving both time and wear.
+//
+//      EEPROMWriteBlock() queues other data for writing the same way. Keep it
+//        out of the journal area (see EEPROM_JOURNAL_START/END below), and don't
+//        change the data until it's written.
+//
+//      Completion can be polled with EEPROMBusy(), or reported on an "interrupt
+//        flag" or an "ISR callback" as with the other modules. EEPROMWait() waits
+//        for the queue to finish, ie - before a reset or power down.
+//
+//      Don't use the <avr/eeprom.h> functions while EEPROMBusy(), since they
+//        share the EEPROM address register with the background writes.
+//
+//      The brown-out detector should be enabled, since a write at low voltage
+//        can write bad data into the cell. The CRC will catch this, and the
+//        previous record will be used.
+//
+//      Data written by versions of this module without the journal (EEPROM_T
+//        stored raw at address 0) is imported at the first boot: if the journal
+//        holds no valid record and is otherwise unused, the block at address 0
+//        is read (see EEPROM_LEGACY_SIZES), migrated, and saved as the first
+//        record. The first record is written past the old block, so a reset
+//        during the import leaves the old data to be imported again.
+//
+//      A journal with a different EEPROM_SLOT_SIZE won't pass the CRC check, and
+//        the defaults will be loaded in its place.
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  MIT LICENSE
@@ -60,6 +135,9 @@
 #define EEPROM_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#include <avr/io.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -83,25 +161,123 @@ typedef struct {
     } EEPROM_T;
 
 //
-// Default values are copied into EEPROM if the mismatched or uninitialized version
+// Default values are copied into EEPROM if uninitialized, or if an older version
+//   can't be migrated
 //
 #define EEPROM_DEFAULTS {                                                               \
     EEPROM_CURR_VERSION,                                                                \
     };
 
+//
+// The journal uses the EEPROM from EEPROM_JOURNAL_START up to (but not including)
+//   EEPROM_JOURNAL_END. Default is the whole device, but part of it can be
+//   reserved for other uses by changing these.
+//
+#define EEPROM_JOURNAL_START    0
+#define EEPROM_JOURNAL_END      (E2END+1)
+
+//
+// Size of each journal slot, 256 or less. Must hold sizeof(EEPROM_T)+5 bytes.
+//
+#define EEPROM_SLOT_SIZE        32
+
+//
+// Steps to upgrade older versions, see EEPROM_INSERT() and friends below. List the
+//   steps for each version in the order they are to be done, using the offsets of
+//   that version's layout. For example, with these layouts
+//
+//      V1: Version, Mode                   V2: Version, Mode, Gain(2)
+//      V3: Version, Gain(2), Offset(4)
+//
+//  #define EEPROM_MIGRATIONS {
+//      EEPROM_INSERT (1,2,2,0),            /* V1 -> V2: add Gain              */
+//      EEPROM_FILL   (1,2,1,100),          /*   ...Gain = 100                 */
+//      EEPROM_MOVE   (2,1,2,2),            /* V2 -> V3: Gain down over Mode   */
+//      EEPROM_DELETE (2,3,1),              /*   ...drop the leftover byte     */
+//      EEPROM_INSERT (2,3,4,0),            /*   ...add Offset                 */
+//      EEPROM_DEFAULT(2,3,4),              /*   ...Offset from defaults       */
+//      }
+//
+// EEPROM_DEFAULT() copies from EEPROM_DEFAULTS, so only use it at the offset the
+//   field has in the current version.
+//
+#define EEPROM_MIGRATIONS {                                                             \
+    }
+
+//
+// Size of EEPROM_T for each version stored by the module without the journal,
+//   which kept it raw at address 0. Indexed by version, and zero (or missing)
+//   means that version was never stored that way. The default is the layout in
+//   this file, so when EEPROM_CURR_VERSION is bumped, write the old entry down
+//   as a number. For example, if V1 was 12 bytes and V2 was 16:
+//
+//  #define EEPROM_LEGACY_SIZES { [1] = 12, [2] = 16 }
+//
+#define EEPROM_LEGACY_SIZES     { [EEPROM_CURR_VERSION] = sizeof(EEPROM_T) }
+
+//
+// Number of blocks which can wait in the write queue. Must be a power of 2, and the
+//   journal uses one of them.
+//
+#define EEPROM_QUEUE_SIZE       4
+
+//
+// Max number of unchanged bytes skipped in one pass of the ISR. Each one takes a
+//   few cycles to read and compare.
+//
+#define EEPROM_MAX_SKIP         16
+
+//
+// Polled mode/ISR mode depends on the next definition.
+//
+// Defined (ie - uncommented) means call the ISR when the queue has been written.
+//   Undefined (commented out) means set the flag instead.
+//
+//#define CALL_EEPROMDone_ISR
+
 //
 // End of user configurable options
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//
+// Migration steps. Version is the one being upgraded from.
+//
+typedef struct {
+    uint8_t     Version;                            // Version step applies to
+    uint8_t     Op;                                 // What to do
+    uint8_t     Offset;                             // Where to do it
+    uint8_t     Len;                                // Number of bytes
+    uint8_t     Arg;                                // Fill value, or source offset
+    } EEPROM_STEP;
+
+#define EEPROM_OP_INSERT        1
+#define EEPROM_OP_DELETE        2
+#define EEPROM_OP_FILL          3
+#define EEPROM_OP_DEFAULT       4
+#define EEPROM_OP_MOVE          5
+
+#define EEPROM_INSERT(_v_,_off_,_len_,_val_) { _v_, EEPROM_OP_INSERT , _off_, _len_, _val_ }  // Add field
+#define EEPROM_DELETE(_v_,_off_,_len_)       { _v_, EEPROM_OP_DELETE , _off_, _len_, 0     }  // Remove field
+#define EEPROM_FILL(_v_,_off_,_len_,_val_)   { _v_, EEPROM_OP_FILL   , _off_, _len_, _val_ }  // Set bytes
+#define EEPROM_DEFAULT(_v_,_off_,_len_)      { _v_, EEPROM_OP_DEFAULT, _off_, _len_, 0     }  // Set to default
+#define EEPROM_MOVE(_v_,_dst_,_src_,_len_)   { _v_, EEPROM_OP_MOVE   , _dst_, _len_, _src_ }  // Move bytes
+
 extern EEPROM_T    EEPROM;
 
+#ifndef CALL_EEPROMDone_ISR
+extern volatile bool EEPROMDone;                    // Set TRUE when queue is written
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // EEPROMInit - Initialize RAM copy of EEPROM 
 //
+// Load the newest valid record in the journal, migrating it if from an older
+//   version, or the defaults if none.
+//
 // Inputs:      None.
 //
 // Outputs:     None.
@@ -114,6 +290,9 @@ void EEPROMInit(void);
 //
 // EEPROMWrite - Write new EEPROM values from RAM
 //
+// Values are appended to the journal as a new record, written in the background.
+//   If the previous record is still being written, wait for it first.
+//
 // Inputs:      None.
 //
 // Outputs:     None.
@@ -121,4 +300,60 @@ void EEPROMInit(void);
 void EEPROMWrite(void);
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMWriteBlock - Queue a block of RAM to be written to EEPROM
+//
+// Inputs:      Ptr to data to write (must remain unchanged until written)
+//              EEPROM address to write to
+//              Number of bytes to write
+//
+// Outputs:     TRUE  if block was queued
+//              FALSE if queue is full
+//
+bool EEPROMWriteBlock(const void *Src,uint16_t Addr,uint16_t Len);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMBusy - Return TRUE if queued writes are in progress
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if writes still in progress
+//              FALSE if all writes are finished
+//
+bool EEPROMBusy(void);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMWait - Wait for queued writes to finish
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void EEPROMWait(void);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EEPROMDone_ISR - User's "queue written" routine
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+// NOTE: Only defined if CALL_EEPROMDone_ISR is #defined, see above.
+//
+#ifdef CALL_EEPROMDone_ISR
+void EEPROMDone_ISR(void);
+#endif
+
+
 #endif  // EEPROM_H - entire file
@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Event.c
+//
+//  DESCRIPTION
+//
+//      Cooperative event loop
+//
+//      Run handlers for events posted from interrupt routines, in priority order.
+//
+//      See Event.h for an in-depth description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "PortMacros.h"
+#include "TimerMacros.h"
+#include "Event.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static struct {
+    volatile uint8_t    Pending;                // One bit per pending event
+    volatile uint8_t    Posts[NUM_EVENTS];      // Posts since handler last ran
+    EVENT_HANDLER       Handlers[NUM_EVENTS];   // Handler for each event
+#ifdef EVENT_STATS
+    EVENT_STATS_T       Stats[NUM_EVENTS];      // Execution statistics
+#endif
+    } Event NOINIT;
+
+#ifdef EVENT_STATS
+#define PRTIMx      _PRTIM(EVENT_TIMER_ID)
+#define TCNTx       _TCNT(EVENT_TIMER_ID)
+#define TCCRAx      _TCCRA(EVENT_TIMER_ID)
+#define TCCRBx      _TCCRB(EVENT_TIMER_ID)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventInit - Initialize event system
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void EventInit(void) {
+
+    memset(&Event,0,sizeof(Event));
+
+#ifdef EVENT_STATS
+#if defined(_AVR_IOM1284P_H_) || defined(_AVR_IOM2560_H_)
+    _CLR_BIT(PRR0,PRTIMx);          // Powerup the clock
+#else
+    _CLR_BIT(PRR,PRTIMx);           // Powerup the clock
+#endif
+
+    //
+    // Setup the timer as free running, normal mode, no interrupts
+    //
+    TCCRAx = 0;
+    TCCRBx = EVENT_CLOCK_BITS;
+    TCNTx  = 0;
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventSetHandler - Set handler to run for an event
+//
+// Inputs:      Event number (ie - EVENT_UART)
+//              Handler to run, or NULL for none
+//
+// Outputs:     None.
+//
+void EventSetHandler(uint8_t EventID,EVENT_HANDLER Handler) {
+
+    if( EventID >= NUM_EVENTS )
+        return;
+
+    Event.Handlers[EventID] = Handler;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventPost - Post an event
+//
+// Inputs:      Event number to post
+//
+// Outputs:     None.
+//
+void EventPost(uint8_t EventID) {
+    uint8_t SaveSREG = SREG;
+
+    if( EventID >= NUM_EVENTS )
+        return;
+
+    cli();                          // Interrupts may also post
+
+    if( Event.Posts[EventID] < 255 )
+        Event.Posts[EventID]++;
+    Event.Pending |= _PIN_MASK(EventID);
+
+    SREG = SaveSREG;                // Restore interrupt state
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventDispatch - Run the highest priority pending event, if any
+//
+// The pending bit and post count are taken atomically, then the handler is
+//   run with interrupts enabled. Posts that arrive while the handler runs
+//   cause it to be run again.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if a handler was run
+//              FALSE if no events were pending
+//
+bool EventDispatch(void) {
+    uint8_t EventID;
+    uint8_t Count;
+
+    if( !Event.Pending )
+        return false;
+
+    //
+    // Lowest numbered pending event has highest priority
+    //
+    for( EventID=0; EventID<NUM_EVENTS; EventID++ ) {
+        if( _BIT_ON(Event.Pending,EventID) )
+            break;
+        }
+
+    cli();
+    Count = Event.Posts[EventID];
+    Event.Posts[EventID] = 0;
+    _CLR_BIT(Event.Pending,EventID);
+    sei();
+
+    if( Event.Handlers[EventID] == NULL )
+        return true;
+
+#ifdef EVENT_STATS
+    uint16_t Start = TCNTx;
+
+    Event.Handlers[EventID](Count);
+
+    uint16_t Elapsed = TCNTx - Start;
+
+    Event.Stats[EventID].Runs++;
+    Event.Stats[EventID].Total += Elapsed;
+    if( Event.Stats[EventID].Max < Elapsed )
+        Event.Stats[EventID].Max = Elapsed;
+#else
+    Event.Handlers[EventID](Count);
+#endif
+
+    return true;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventLoop - Run event handlers forever, sleeping when idle
+//
+// The sleep instruction following sei() is always executed before any pending
+//   interrupt, so an event posted between the check and the sleep will wake
+//   the CPU rather than be missed.
+//
+// Inputs:      None.
+//
+// Outputs:     None. (Never returns)
+//
+void EventLoop(void) {
+
+    while(1) {
+
+        if( EventDispatch() )
+            continue;
+
+        cli();
+        if( !Event.Pending ) {
+            sleep_enable();
+            sei();
+            sleep_cpu();
+            sleep_disable();
+            }
+        sei();
+        }
+    }
+
+#ifdef EVENT_STATS
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventGetStats   - Return statistics for an event handler
+// EventClearStats - Clear all handler statistics
+//
+// Inputs:      Event number to return
+//              Ptr to returned statistics
+//
+// Outputs:     None.
+//
+void EventGetStats(uint8_t EventID,EVENT_STATS_T *Stats) {
+
+    if( EventID >= NUM_EVENTS ) {
+        memset(Stats,0,sizeof(*Stats));
+        return;
+        }
+
+    *Stats = Event.Stats[EventID];
+    }
+
+void EventClearStats(void) { memset(Event.Stats,0,sizeof(Event.Stats)); }
+#endif
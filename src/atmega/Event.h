@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Event.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In Timer.h, UART.h, AtoD.h, Button.h, I2C.h
+//      //
+//      #define POST_TimerEvent             // Post EVENT_TIMER  at each tick
+//      #define POST_UARTEvent              // Post EVENT_UART   at each Rx char
+//      #define POST_AtoDEvent              // Post EVENT_ATOD   when scan complete
+//      #define POST_ButtonEvent            // Post EVENT_BUTTON when buttons change
+//      #define POST_I2CEvent               // Post EVENT_I2C    when transfer complete
+//
+//      //////////////////////////////////////
+//      //
+//      // In main.c
+//      //
+//      void UARTHandler(uint8_t Count) {   // Count == Number of posts since last run
+//          char InChar;
+//
+//          while( (InChar = GetUARTByte()) )
+//              ProcessInput(InChar);
+//          }
+//
+//      void TimerHandler(uint8_t Count) {
+//          TimerUpdate();                  // Calls TimerISR, ButtonUpdate, &c
+//          }
+//
+//      set_sleep_mode(SLEEP_MODE_IDLE);    // Sleep mode to use when idle
+//
+//      EventInit();
+//      EventSetHandler(EVENT_UART ,UARTHandler);
+//      EventSetHandler(EVENT_TIMER,TimerHandler);
+//
+//      TimerInit();
+//      UARTInit();
+//
+//      sei();                              // Enable interrupts
+//
+//      EventLoop();                        // Never returns
+//
+//      //////////////////////////////////////
+//      //
+//      // From an ISR (or anywhere)
+//      //
+//      EventPost(EVENT_USER0);             // Handler will run from main loop
+//
+//      //////////////////////////////////////
+//      //
+//      // Handler statistics
+//      //
+//      EVENT_STATS_T Stats;
+//
+//      EventGetStats(EVENT_UART,&Stats);   // Runs, total and max clocks
+//      EventClearStats();                  // Start new measurement
+//
+//  DESCRIPTION
+//
+//      Cooperative event loop
+//
+//      Instead of each program polling GetUARTByte, TimerUpdate, ButtonUpdate
+//        and so on in a hand-rolled while(1) loop, interrupt routines post an
+//        event and the main loop runs the matching handler.
+//
+//      Events are numbered in priority order: event 0 is the most important.
+//        The loop always runs the highest priority pending event next, and each
+//        handler runs to completion before the next one is chosen.
+//
+//      Posting an event that is already pending does not queue a second run;
+//        instead, the handler is passed the number of posts since it last ran
+//        (saturating at 255) so it can tell how much work is waiting.
+//
+//      When no events are pending, the loop sleeps using whatever sleep mode
+//        the caller has chosen with set_sleep_mode(). The check and the sleep
+//        are done atomically, so an event posted just before sleeping can't
+//        be missed.
+//
+//      With EVENT_STATS #defined, each handler is timed with a free running
+//        16-bit timer, to find which handler is eating the loop.
+//
+//  NOTES
+//
+//      The modules only post events if their POST_xxxEvent option is enabled,
+//        so programs that don't use the event loop are unaffected.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Event numbers, in priority order (0 == highest priority)
+//
+// The USER events are available for the application to post from its own
+//   interrupt routines, or from other handlers.
+//
+#define EVENT_UART          0                   // Rx char received
+#define EVENT_TIMER         1                   // Timer tick
+#define EVENT_ATOD          2                   // AtoD scan complete
+#define EVENT_BUTTON        3                   // Button change
+#define EVENT_I2C           4                   // I2C transfer complete
+#define EVENT_USER0         5
+#define EVENT_USER1         6
+#define EVENT_USER2         7
+
+#define NUM_EVENTS          8                   // Max 8, one bit per event
+
+//
+// Handler statistics depend on the next definition.
+//
+// Defined (ie - uncommented) means time each handler using a free running
+//   timer. EVENT_TIMER_ID selects a 16-bit timer that is not otherwise used,
+//   and EVENT_CLOCK_BITS its clock select bits.
+//
+// The default is timer 1 at F_CPU/64, for 4 us per count at 16 MHz. Handlers
+//   longer than 65535 counts (262 ms) will be mis-measured.
+//
+//#define EVENT_STATS
+
+#define EVENT_TIMER_ID      1
+#define EVENT_CLOCK_BITS    (_PIN_MASK(_CS1(EVENT_TIMER_ID)) | _PIN_MASK(_CS0(EVENT_TIMER_ID)))
+#define EVENT_CLOCK_PRESCALE 64
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+typedef void (*EVENT_HANDLER)(uint8_t Count);
+
+typedef struct {
+    uint32_t    Runs;                           // Number of times handler was run
+    uint32_t    Total;                          // Total clocks spent in handler
+    uint16_t    Max;                            // Longest single run, in clocks
+    } EVENT_STATS_T;
+
+#define EVENT_CLOCKS_TO_US(_c_)     ((_c_)*EVENT_CLOCK_PRESCALE/(F_CPU/1000000))
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventInit - Initialize event system
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void EventInit(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventSetHandler - Set handler to run for an event
+//
+// Inputs:      Event number (ie - EVENT_UART)
+//              Handler to run, or NULL for none
+//
+// Outputs:     None.
+//
+void EventSetHandler(uint8_t Event,EVENT_HANDLER Handler);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventPost - Post an event
+//
+// Inputs:      Event number to post
+//
+// Outputs:     None.
+//
+// NOTE: May be called from interrupt or from main loop
+//
+void EventPost(uint8_t Event);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventDispatch - Run the highest priority pending event, if any
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if a handler was run
+//              FALSE if no events were pending
+//
+bool EventDispatch(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventLoop - Run event handlers forever, sleeping when idle
+//
+// Inputs:      None.
+//
+// Outputs:     None. (Never returns)
+//
+void EventLoop(void) __attribute__((noreturn));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventGetStats   - Return statistics for an event handler
+// EventClearStats - Clear all handler statistics
+//
+// Inputs:      Event number to return
+//              Ptr to returned statistics
+//
+// Outputs:     None.
+//
+// NOTE: Only defined if EVENT_STATS is #defined, see above.
+//
+#ifdef EVENT_STATS
+void EventGetStats(uint8_t Event,EVENT_STATS_T *Stats);
+void EventClearStats(void);
+#endif
+
+#endif  // EVENT_H - entire file
@@ -57,13 +57,52 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#ifndef FREQ_RECIPROCAL
+
+#define FREQ_WINDOW_TICKS   (FREQ_WINDOW_MS/MS_PER_TICK)
+
 static struct {
-    uint16_t    Counts[TICKS_PER_SEC];              // Counter values for last 1 second
+    uint16_t    Counts[FREQ_WINDOW_TICKS];          // Counter values for each tick in window
     uint16_t    *Ptr;                               // Index to next place to store values
+    uint32_t    Total;                              // Sum of Counts[]
     uint16_t    PrevTimer;                          // Previous extended timer
     uint8_t     TimerExt;                           // Extended timer count
     } Freq NOINIT;
 
+#else
+
+#define FREQ_GATE_TICKS     (FREQ_GATE_MS/MS_PER_TICK)
+#define FREQ_TIMEOUT_TICKS  (FREQ_TIMEOUT_MS/MS_PER_TICK)
+
+//
+// Written by the ISRs
+//
+static volatile struct {
+    uint32_t    EdgeExt;                            // Upper bits of edge count
+    uint16_t    TimeExt;                            // Upper 16 bits of Timer1
+    uint32_t    SyncEdges;                          // Edge count  at sync edge
+    uint32_t    SyncTime;                           // Timer1 time of sync edge
+    uint16_t    SyncLatency;                        // Timer1 counts from edge to edge count read
+    bool        Synced;                             // TRUE if new sync edge captured
+    } FreqSync NOINIT;
+
+//
+// Used by FreqUpdate
+//
+static struct {
+    uint32_t    PrevEdges;                          // Edge count  at previous sync edge
+    uint32_t    PrevTime;                           // Timer1 time of previous sync edge
+    uint16_t    PrevLatency;                        // Latency     of previous sync edge
+    bool        HavePrev;                           // TRUE if Prev values are valid
+    bool        Armed;                              // TRUE if waiting for sync edge
+    uint16_t    GateTicks;                          // Ticks since sync was last armed
+    uint16_t    WaitTicks;                          // Ticks since last sync edge
+    uint32_t    Edges;                              // Last result: input edges
+    uint32_t    Cycles;                             // Last result: CPU cycles
+    } Freq NOINIT;
+
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Setup some port designations
@@ -91,6 +130,49 @@ static struct {
 #define DISABLE_INT { TIMSKx = 0; }                 // Disable timer interrupts
 #define ENABLE_INT  { TIMSKx = _PIN_MASK(TOIEx); }  // Allow interrupts
 
+#ifdef FREQ_RECIPROCAL
+//
+// Timer1 timestamps the sync edge
+//
+#define SYNC_TIMER_ID   1
+#define PRTIMy          _PRTIM(SYNC_TIMER_ID)
+#define SYNC_ISR        _TCAPT_VECT(SYNC_TIMER_ID)
+#define OFLO_ISR        _TOVF_VECT(SYNC_TIMER_ID)
+
+#define TCCRAy          _TCCRA(SYNC_TIMER_ID)
+#define TCCRBy          _TCCRB(SYNC_TIMER_ID)
+#define TIMSKy          _TIMSK(SYNC_TIMER_ID)
+#define TIFRy           _TIFR(SYNC_TIMER_ID)
+#define TCNTy           _TCNT(SYNC_TIMER_ID)
+#define ICRy            _ICR(SYNC_TIMER_ID)
+#define ICIEy           _ICIE(SYNC_TIMER_ID)
+#define TOIEy           _TOIE(SYNC_TIMER_ID)
+#define ICFy            _ICF(SYNC_TIMER_ID)
+#define TOVy            _TOV(SYNC_TIMER_ID)
+
+#define TIFRx           _TIFR(FREQ_TIMER_ID)
+#define TOVx            _TOV(FREQ_TIMER_ID)
+
+#define SYNC_CLOCK      _PIN_MASK(_CS0(SYNC_TIMER_ID))  // clk I/O /1
+
+#ifdef FREQ_RISING_EDGE
+#define SYNC_EDGE       _PIN_MASK(_ICES(SYNC_TIMER_ID))
+#else
+#define SYNC_EDGE       0
+#endif
+
+#if defined(_AVR_IOM1284P_H_)
+#define ICP_PORT        D                           // ICP1 == PD6
+#define ICP_PIN         6
+#elif defined(_AVR_IOM2560_H_)
+#define ICP_PORT        D                           // ICP1 == PD4
+#define ICP_PIN         4
+#else
+#define ICP_PORT        B                           // ICP1 == PB0
+#define ICP_PIN         0
+#endif
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -105,7 +187,26 @@ void FreqInit(void) {
 
     memset(&Freq,0,sizeof(Freq));
 
+#ifndef FREQ_RECIPROCAL
     Freq.Ptr = Freq.Counts;
+#else
+    memset((void *) &FreqSync,0,sizeof(FreqSync));
+
+    _CLR_BIT(PRR,PRTIMy);           // Powerup the clock
+
+    _CLR_BIT(_DDR(ICP_PORT),ICP_PIN);   // ICP is an input
+
+    //
+    // Setup the timestamp timer as free running at full clock speed. The capture
+    //   interrupt is only enabled when a sync edge is wanted.
+    //
+    TCCRAy = 0;                     // Normal counter
+    TCCRBy = SYNC_CLOCK | SYNC_EDGE;
+    TCNTy  = 0;
+
+    TIFRy  = _PIN_MASK(ICFy) | _PIN_MASK(TOVy);
+    TIMSKy = _PIN_MASK(TOIEy);
+#endif
 
     _CLR_BIT(PRR,PRTIMx);           // Powerup the clock
 
@@ -119,6 +220,8 @@ void FreqInit(void) {
     ENABLE_INT;                     // Allow interrupts
     }
 
+#ifndef FREQ_RECIPROCAL
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -147,8 +250,14 @@ void FreqUpdate(void) {
     ENABLE_INT;
 
     uint16_t CurrTimer = (ExtCopy << 8) + TimerCopy;
+    uint16_t Count     = CurrTimer-Freq.PrevTimer;
 
-    *Freq.Ptr++     = CurrTimer-Freq.PrevTimer;
+    //
+    // Keep the running total: add in the new count, take out the one it replaces
+    //
+    Freq.Total     += Count;
+    Freq.Total     -= *Freq.Ptr;
+    *Freq.Ptr++     = Count;
      Freq.PrevTimer = CurrTimer;
 
     //
@@ -163,19 +272,173 @@ void FreqUpdate(void) {
 //
 // GetFreq - Return currently measured frequency
 //
+// FreqUpdate() may be called from the timer interrupt, so the total is read
+//   with interrupts off.
+//
 // Inputs:      None.
 //
-// Outputs:     Measured frequency over the last second
+// Outputs:     Measured frequency over the last FREQ_WINDOW_MS
 //
-uint16_t GetFreq(void) { 
-    uint16_t Result = 0;
+uint32_t GetFreq(void) { 
+    uint8_t  SaveSREG = SREG;
+    uint32_t Total;
 
-    for( uint8_t i=0; i<NUMOF(Freq.Counts); i++ )
-        Result += Freq.Counts[i];
+    cli();
+    Total = Freq.Total;
+    SREG  = SaveSREG;
 
-    return Result;
+#if FREQ_WINDOW_MS == 1000
+    return Total;
+#else
+    return ((uint64_t) Total*1000 + FREQ_WINDOW_MS/2)/FREQ_WINDOW_MS;
+#endif
     }
 
+#else   // FREQ_RECIPROCAL
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreqUpdate - Update frequency
+//
+// Completes a measurement when a sync edge has been captured, and arms the
+//   capture for the next sync edge when the gate time is up.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void FreqUpdate(void) {
+
+    //
+    // A new sync edge completes a measurement. The ISR has turned itself off,
+    //   so the sync values can't change while we read them.
+    //
+    if( FreqSync.Synced ) {
+        uint32_t SyncEdges   = FreqSync.SyncEdges;
+        uint32_t SyncTime    = FreqSync.SyncTime;
+        uint16_t SyncLatency = FreqSync.SyncLatency;
+
+        FreqSync.Synced = false;
+        Freq.Armed      = false;
+        Freq.WaitTicks  = 0;
+
+        if( Freq.HavePrev ) {
+            uint32_t Edges  = SyncEdges - Freq.PrevEdges;
+            uint32_t Cycles = SyncTime  - Freq.PrevTime;
+            int32_t  dLatency = (int32_t) SyncLatency - Freq.PrevLatency;
+
+            //
+            // Edges arriving between the sync edge and the count read were
+            //   counted early. Take out the difference between the two ends.
+            //
+            if( dLatency != 0 && Cycles != 0 ) {
+                int64_t Extra = (int64_t) dLatency * Edges;
+
+                Extra += (Extra < 0) ? -(int64_t) (Cycles/2) : (int64_t) (Cycles/2);
+                Edges -= Extra/(int64_t) Cycles;
+                }
+
+            Freq.Edges  = Edges;
+            Freq.Cycles = Cycles;
+            }
+
+        Freq.PrevEdges   = SyncEdges;
+        Freq.PrevTime    = SyncTime;
+        Freq.PrevLatency = SyncLatency;
+        Freq.HavePrev    = true;
+        }
+
+    //
+    // No edges at all for the timeout: the input has stopped. Start over when it
+    //   comes back, since the timestamps wrap after 268 seconds.
+    //
+    if( Freq.Armed && ++Freq.WaitTicks >= FREQ_TIMEOUT_TICKS ) {
+        Freq.Edges     = 0;
+        Freq.Cycles    = 0;
+        Freq.HavePrev  = false;
+        Freq.WaitTicks = 0;
+        }
+
+    //
+    // At the end of the gate time, sync to the next input edge
+    //
+    if( ++Freq.GateTicks >= FREQ_GATE_TICKS && !Freq.Armed ) {
+        Freq.GateTicks = 0;
+        Freq.Armed     = true;
+        TIFRy   = _PIN_MASK(ICFy);  // Clear stale captures
+        _SET_BIT(TIMSKy,ICIEy);
+        }
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// GetFreq - Return currently measured frequency
+//
+// Inputs:      None.
+//
+// Outputs:     Measured frequency, rounded to the nearest Hz
+//
+uint32_t GetFreq(void) { 
+    uint32_t Edges;
+    uint32_t Cycles;
+
+    FreqGetRaw(&Edges,&Cycles);
+
+    if( Cycles == 0 )
+        return 0;
+
+    return ((uint64_t) Edges*F_CPU + Cycles/2)/Cycles;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreqGetMilliHz - Return measured frequency in milli-Hz
+//
+// Inputs:      None.
+//
+// Outputs:     Frequency * 1000, saturating at 0xFFFFFFFF (about 4.29 MHz)
+//
+uint32_t FreqGetMilliHz(void) {
+    uint32_t Edges;
+    uint32_t Cycles;
+
+    FreqGetRaw(&Edges,&Cycles);
+
+    if( Cycles == 0 )
+        return 0;
+
+    uint64_t MilliHz = ((uint64_t) Edges*(F_CPU*1000ULL) + Cycles/2)/Cycles;
+
+    return MilliHz > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : MilliHz;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreqGetRaw - Return the last measurement
+//
+// FreqUpdate() may be called from the timer interrupt, so the values are read
+//   with interrupts off.
+//
+// Inputs:      Ptr to receive input edges  (zero if no signal)
+//              Ptr to receive CPU cycles   (zero if no signal)
+//
+// Outputs:     None.
+//
+void FreqGetRaw(uint32_t *Edges,uint32_t *Cycles) {
+    uint8_t SaveSREG = SREG;
+
+    cli();
+    *Edges  = Freq.Edges;
+    *Cycles = Freq.Cycles;
+    SREG    = SaveSREG;
+    }
+
+#endif  // FREQ_RECIPROCAL
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -188,4 +451,67 @@ uint16_t GetFreq(void) {
 //
 // Outputs:     None.
 //
+#ifndef FREQ_RECIPROCAL
 ISR(FREQ_ISR,ISR_NOBLOCK) { Freq.TimerExt++; }
+#else
+//
+// The capture ISR reads EdgeExt, so this must not be interrupted part way
+//   through the update.
+//
+ISR(FREQ_ISR) { FreqSync.EdgeExt++; }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMER1_OVF_vect - Overflow timestamp count
+//
+// Just increment the extended word, making an equivalent 32-bit timer
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(OFLO_ISR) { FreqSync.TimeExt++; }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMER1_CAPT_vect - Sync edge captured
+//
+// Timer1 latched the edge time in hardware, but the edge count has to be read
+//   here, some time later. The count is read first, and the delay up to that
+//   point is recorded so FreqUpdate() can correct for edges that came in
+//   meanwhile.
+//
+// Overflows that happened before the reads but haven't been serviced yet are
+//   picked up from the flags, as in Capture.c. A small count means the read was
+//   after the overflow, so the pending overflow belongs to it.
+//
+// Runs with interrupts off, so the overflow ISRs can't change the extensions
+//   in the middle of this.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(SYNC_ISR) {
+    uint8_t  Count   = TCNTx;
+    uint16_t Now     = TCNTy;
+    uint16_t Capt    = ICRy;
+    uint32_t EdgeExt = FreqSync.EdgeExt;
+    uint16_t TimeExt = FreqSync.TimeExt;
+
+    if( _BIT_ON(TIFRx,TOVx) && Count < 0x80 )
+        EdgeExt++;
+
+    if( _BIT_ON(TIFRy,TOVy) && Capt < 0x8000 )
+        TimeExt++;
+
+    FreqSync.SyncEdges   = (EdgeExt << 8) | Count;
+    FreqSync.SyncTime    = ((uint32_t) TimeExt << 16) | Capt;
+    FreqSync.SyncLatency = Now - Capt;
+    FreqSync.Synced      = true;
+
+    _CLR_BIT(TIMSKy,ICIEy);         // One sync edge per gate
+    }
+#endif
@@ -23,6 +23,8 @@
 //      // In Freq.h
 //      //
 //      ...Choose a timer                  (Default: Timer0)
+//      ...Choose reciprocal mode          (Default: Off)
+//      ...Choose gate time                (Default: 1 second)
 //
 //      //////////////////////////////////////
 //      //
@@ -45,6 +47,49 @@
 //
 //      Calculate precision frequency using Timer0
 //
+//      In the default mode, Timer0 counts input edges and the count is summed
+//        over the last FREQ_WINDOW_MS, so the resolution is 1 Hz for a 1 second
+//        window. That's fine at high frequencies, but useless at a few Hz.
+//
+//      The count for each timer tick is kept, and a running total is updated
+//        as each new count comes in and the oldest drops out, so reading the
+//        frequency is quick. The per-tick counts are 16 bits, which limits the
+//        input to 65535 edges per tick (1.6 MHz at 25 ticks/sec).
+//
+//      In reciprocal mode (#define FREQ_RECIPROCAL) the input is also wired to
+//        ICP1, and Timer1 timestamps edges at the full CPU clock. At the end of
+//        each gate time the next input edge is captured, along with the edge
+//        count at that moment. Between two such "sync" edges there are a whole
+//        number of input cycles, so
+//
+//          Frequency = (Edges between sync edges) * F_CPU / (Cycles between them)
+//
+//        The resolution is set by the 62.5 nS timestamp rather than by the
+//        input frequency: at a 1 second gate it is 1 part in 16 million,
+//        about 0.06 ppm, whether the input is 1 Hz or 1 MHz.
+//
+//      This ranges automatically. At high frequencies there are many edges
+//        per gate. At low frequencies the measurement stretches to the first
+//        edge after the gate time, which makes it a period measurement: below
+//        1 Hz each result spans a single input cycle. With no edge for
+//        FREQ_TIMEOUT_MS the result is zero.
+//
+//      The edge count is read in the capture ISR, a few uS after the sync edge.
+//        Above a few hundred KHz more edges arrive in that time; they are
+//        subtracted out using the interrupt latency (measured with Timer1) and
+//        the frequency, so that jitter from other interrupts doesn't show up
+//        in the result.
+//
+//  NOTES
+//
+//      In reciprocal mode the input goes to both T0 (PD4) and ICP1 (PB0) on the
+//        328. Timer1 is used, so this can't be used with Capture.c, PWM.c on
+//        Timer1, or anything else on Timer1.
+//
+//      The result is only as good as the CPU clock. A ceramic resonator is
+//        good to about 0.5%, and a crystal to 30 ppm or so; calibrate against
+//        a known frequency for better.
+//
 //  EXAMPLE
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -90,12 +135,43 @@
 //
 #define FREQ_RISING_EDGE
 
+//
+// Time over which edges are counted in the default mode. Must be a multiple of
+//   the timer tick, and takes 2 bytes of RAM per tick.
+//
+#define FREQ_WINDOW_MS      1000
+
+//
+// Reciprocal counting depends on the next definition.
+//
+// Defined (ie - uncommented) means use reciprocal mode, see above. FREQ_GATE_MS
+//   is the minimum measurement time, and must be a multiple of the timer tick.
+//
+//#define FREQ_RECIPROCAL
+
+#define FREQ_GATE_MS        1000
+#define FREQ_TIMEOUT_MS     10000               // No edge for this long reads as zero
+
 //
 // End of user configurable options
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#if (FREQ_WINDOW_MS % MS_PER_TICK) != 0 || FREQ_WINDOW_MS < MS_PER_TICK
+#error "Freq: FREQ_WINDOW_MS must be a multiple of the timer tick"
+#endif
+
+#ifdef FREQ_RECIPROCAL
+#if FREQ_TIMER_ID != 0
+#error "Freq: FREQ_RECIPROCAL needs FREQ_TIMER_ID 0, since Timer1 does the timestamps"
+#endif
+
+#if (FREQ_GATE_MS % MS_PER_TICK) != 0
+#error "Freq: FREQ_GATE_MS must be a multiple of the timer tick"
+#endif
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -113,6 +189,8 @@ void FreqInit(void);
 //
 // FreqUpdate - Update frequency measurement
 //
+// Call once per timer tick.
+//
 // Inputs:      None.
 //
 // Outputs:     None.
@@ -127,9 +205,43 @@ void FreqUpdate(void);
 //
 // Inputs:      None.
 //
-// Outputs:     Measured frequency
+// Outputs:     Measured frequency, in Hz
+//
+uint32_t GetFreq(void);
+
+
+#ifdef FREQ_RECIPROCAL
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreqGetMilliHz - Return measured frequency in milli-Hz
+//
+// Inputs:      None.
+//
+// Outputs:     Frequency * 1000, saturating at 0xFFFFFFFF (about 4.29 MHz)
+//
+// NOTE: Only defined if FREQ_RECIPROCAL is #defined, see above.
+//
+uint32_t FreqGetMilliHz(void);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreqGetRaw - Return the last measurement
+//
+// Frequency == Edges * F_CPU / Cycles, for callers wanting full precision or a
+//   calibrated clock.
+//
+// Inputs:      Ptr to receive input edges  (zero if no signal)
+//              Ptr to receive CPU cycles   (zero if no signal)
+//
+// Outputs:     None.
+//
+// NOTE: Only defined if FREQ_RECIPROCAL is #defined, see above.
 //
-uint16_t GetFreq(void);
+void FreqGetRaw(uint32_t *Edges,uint32_t *Cycles);
+#endif
 
 
 #endif  // FREQ_H - entire file
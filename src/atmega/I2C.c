@@ -71,6 +71,14 @@
 
 #include "PortMacros.h"
 #include "I2C.h"
+#include "Profile.h"
+
+#ifdef POST_I2CEvent
+#include "Event.h"
+#define POST_I2C    EventPost(EVENT_I2C)
+#else
+#define POST_I2C
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -312,6 +320,8 @@ I2C_STATUS I2CStatus(void) { return I2C.Status; }
 ISR(TWI_vect) {
     uint8_t Status = TWSR & (~(_PIN_MASK(TWPS0) | _PIN_MASK(TWPS1)));
 
+    PROFILE_ISR(PROFILE_TWI);
+
     ADD_DEBUG(Status);
     ADD_DEBUG(TWCR);
 
@@ -355,6 +365,8 @@ ISR(TWI_vect) {
                 if( !I2C.NoStop )
                     STOP_I2C;
 
+                POST_I2C;
+
                 ADD_DEBUG(I2C.SlaveAddr);
 #ifdef CALL_I2CISR
                 I2CISR();
@@ -380,6 +392,7 @@ ISR(TWI_vect) {
         case TW_MR_SLA_NACK:
             I2C.Status = I2C_NO_SLAVE_ACK;
             STOP_I2C;
+            POST_I2C;
             ADD_DEBUG(I2C.SlaveAddr);
             return;
 
@@ -390,6 +403,7 @@ ISR(TWI_vect) {
         case TW_MT_DATA_NACK:
             I2C.Status = I2C_SLAVE_DATA_NACK;
             STOP_I2C;
+            POST_I2C;
             ADD_DEBUG(I2C.SlaveAddr);
             return;
 
@@ -403,6 +417,7 @@ ISR(TWI_vect) {
         case TW_ARB_LOST:
             I2C.Status = I2C_ARB_LOST;
             STEP_I2C;
+            POST_I2C;
             ADD_DEBUG(I2C.SlaveAddr);
             return;
 
@@ -420,6 +435,7 @@ ISR(TWI_vect) {
             if( I2C.nBytes == 0 ) {
                 I2C.Status = I2C_COMPLETE;
                 STOP_I2C;
+                POST_I2C;
                 ADD_DEBUG(I2C.SlaveAddr);
                 return;
                 }
@@ -462,6 +478,7 @@ ISR(TWI_vect) {
             if( I2C.nBytes == 0 ) {
                 I2C.Status = I2C_COMPLETE;
                 STOP_I2C;
+                POST_I2C;
 
                 ADD_DEBUG(I2C.SlaveAddr);
 
@@ -484,6 +501,7 @@ ISR(TWI_vect) {
         case TW_BUS_ERROR:
             I2C.Status = I2C_BUS_ERROR;
             STOP_I2C;
+            POST_I2C;
             ADD_DEBUG(I2C.SlaveAddr);
             return;
         }
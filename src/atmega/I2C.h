@@ -83,6 +83,14 @@
 // 
 //#define CALL_I2CISR
 
+//
+// Event loop posting depends on the next definition.
+//
+// Defined (ie - uncommented) means post EVENT_I2C when a transfer completes,
+//   successfully or not. See Event.h
+//
+//#define POST_I2CEvent
+
 //
 // This is a convoluted protocol. Define "debug" below to enable an array of
 //   information to be set while operations are in progress. The main program
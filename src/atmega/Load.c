@@ -0,0 +1,224 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Load.c
+//
+//  SYNOPSIS
+//
+//      See Load.h for a complete description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <string.h>
+
+#include "PortMacros.h"
+#include "Timer.h"
+#include "Load.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static volatile struct {
+    uint32_t    Start;                      // Timer count at start of interval
+    uint32_t    Idle;                       // Idle counts within interval
+    uint32_t    IdleStart;                  // Timer count at start of idle
+    bool        IsIdle;                     // TRUE if currently idle
+    uint8_t     Percent;                    // Load over previous interval
+    uint8_t     Index;                      // Next History[] entry to write
+    uint8_t     History[LOAD_WINDOW];       // Load over recent intervals
+    } Load NOINIT;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadInit - Initialize the load meter
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadInit(void) {
+
+    memset((void *) &Load,0,sizeof(Load));
+
+    Load.Start = TimerGetCounts();
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadUpdate - Compute the load once a second
+//
+// An idle period in progress is split at the end of the interval, with the part
+//   so far counted in this interval and the remainder in the next.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if a new result is available
+//              FALSE otherwise
+//
+bool LoadUpdate(void) {
+    uint32_t Now      = TimerGetCounts();
+    uint32_t Interval = Now - Load.Start;
+    uint32_t Idle;
+    uint32_t Busy;
+
+    if( Interval < TIMER_HZ )
+        return false;
+
+    uint8_t SaveSREG = SREG;        // Protect against LoadIdleEnd() and
+    cli();                          //   LoadUpdate() in different contexts
+
+    Idle = Load.Idle;
+    if( Load.IsIdle ) {
+        Idle          += Now - Load.IdleStart;
+        Load.IdleStart = Now;
+        }
+    Load.Idle  = 0;
+    Load.Start = Now;
+
+    SREG = SaveSREG;
+
+    //
+    // Scale a late (long) interval down so that the percent calculation can't
+    //   overflow.
+    //
+    if( Idle > Interval )
+        Idle = Interval;
+    Busy = Interval - Idle;
+
+    while( Interval > 0x00FFFFFFUL ) {
+        Interval >>= 1;
+        Busy     >>= 1;
+        }
+
+    Load.Percent = (Busy*100 + Interval/2)/Interval;
+
+    Load.History[Load.Index++] = Load.Percent;
+    if( Load.Index >= LOAD_WINDOW )
+        Load.Index = 0;
+
+    return true;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadIdleBegin - Mark start of idle time
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadIdleBegin(void) {
+
+    if( Load.IsIdle )
+        return;
+
+    uint32_t Now = TimerGetCounts();
+
+    uint8_t SaveSREG = SREG;
+    cli();
+    Load.IdleStart = Now;
+    Load.IsIdle    = true;
+    SREG = SaveSREG;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadIdleEnd - Mark end of idle time
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadIdleEnd(void) {
+
+    if( !Load.IsIdle )
+        return;
+
+    uint8_t SaveSREG = SREG;
+    cli();
+    Load.Idle  += TimerGetCounts() - Load.IdleStart;
+    Load.IsIdle = false;
+    SREG = SaveSREG;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadSleep - Sleep the CPU, counting the time asleep as idle
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadSleep(void) {
+
+    LoadIdleBegin();
+    sleep_cpu();
+    LoadIdleEnd();
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadGetPercent - Return CPU load over the previous second
+// LoadGetPeak    - Return highest load over the last LOAD_WINDOW seconds
+//
+// Inputs:      None.
+//
+// Outputs:     Load, in percent (0 .. 100)
+//
+uint8_t LoadGetPercent(void) { return Load.Percent; }
+
+uint8_t LoadGetPeak(void) {
+    uint8_t Peak = 0;
+
+    for( uint8_t i=0; i<LOAD_WINDOW; i++ ) {
+        if( Load.History[i] > Peak )
+            Peak = Load.History[i];
+        }
+
+    return Peak;
+    }
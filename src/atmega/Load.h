@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Load.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c - sleeping main loop
+//      //
+//      LoadInit();                         // Called once, after TimerInit()
+//          :
+//
+//      while(1) {
+//          TimerUpdate();
+//          LoadUpdate();                   // Closes out each second
+//          LoadSleep();                    // Instead of sleep_cpu()
+//          }
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c - busy polling main loop
+//      //
+//      while(1) {
+//          LoadUpdate();
+//
+//          if( CheckForWork() ) {
+//              LoadIdleEnd();              // Busy from here
+//              ...do the work
+//              }
+//          else LoadIdleBegin();           // Idle from here
+//          }
+//
+//      uint8_t Load = LoadGetPercent();    // == CPU load over the previous second
+//      uint8_t Peak = LoadGetPeak();       // == Max load over the last LOAD_WINDOW secs
+//
+//  DESCRIPTION
+//
+//      CPU load meter
+//
+//      Measures the time the main loop spends idle against wall time, and reports
+//        the CPU load (the percent of time not idle) once a second, along with
+//        the highest load seen over a window of recent seconds.
+//
+//      Both times are taken from the hardware timer used by Timer.c (see
+//        TimerGetCounts()), so no extra timer is used. At the default Timer.h
+//        settings each count is 64 uS, and one second is 15625 counts.
+//
+//      The application marks the idle parts of its main loop. A loop that sleeps
+//        calls LoadSleep() in place of sleep_cpu(), which counts the time asleep
+//        as idle. A loop that busy-polls calls LoadIdleBegin() when a pass finds
+//        nothing to do, and LoadIdleEnd() when it finds work. Both calls may be
+//        repeated: only the first Begin after an End (and vice versa) counts.
+//
+//      LoadUpdate() must be called at least once a tick, from the main loop or
+//        from TimerISR(). When a full second of timer counts has passed since the
+//        last result it computes the load for that interval, and an idle period
+//        still in progress is split at that point so that a long idle stretch
+//        is spread over the seconds it covers.
+//
+//      The interval is measured rather than assumed, so the result stays correct
+//        if LoadUpdate() is called late.
+//
+//  NOTES
+//
+//      Interrupts taken while idle are counted as idle time: when a sleeping
+//        CPU is woken by an interrupt the ISR runs before LoadSleep() returns.
+//        Programs that do significant work in ISRs will read low.
+//
+//      Individual idle periods are measured to the nearest timer count, but the
+//        rounding is random from one period to the next, so it averages out over
+//        the many periods in a second.
+//
+//      Reading the timer costs on the order of 100 CPU cycles, but only on a
+//        change of state: a repeated LoadIdleBegin() or LoadIdleEnd() returns
+//        at once, so it's OK to call them on every pass of a polling loop.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOAD_H
+#define LOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Window for the peak load, in seconds. Takes one byte per second.
+//
+#ifndef LOAD_WINDOW
+#define LOAD_WINDOW     10                          // Peak over last 10 seconds
+#endif
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadInit - Initialize the load meter
+//
+// NOTE: Call after TimerInit().
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadInit(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadUpdate - Compute the load once a second
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if a new result is available
+//              FALSE otherwise
+//
+bool LoadUpdate(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadIdleBegin - Mark start of idle time
+// LoadIdleEnd   - Mark end   of idle time
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadIdleBegin(void);
+void LoadIdleEnd(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadSleep - Sleep the CPU, counting the time asleep as idle
+//
+// Use in place of sleep_cpu(), after sleep_enable().
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void LoadSleep(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadGetPercent - Return CPU load over the previous second
+// LoadGetPeak    - Return highest load over the last LOAD_WINDOW seconds
+//
+// Inputs:      None.
+//
+// Outputs:     Load, in percent (0 .. 100)
+//
+uint8_t LoadGetPercent(void);
+uint8_t LoadGetPeak(void);
+
+#endif  // LOAD_H - entire file
@@ -5,11 +5,11 @@
 //      All Rights Reserved under the MIT license as outlined below.
 //
 //  FILE
-//      Freq.c
+//      PWM.c
 //
 //  DESCRIPTION
 //
-//      Frequency processing
+//      PWM processing
 //
 //      Setup a timer as a real-time frequency counter
 //
@@ -46,6 +46,8 @@
 
 #include "PWM.h"
 #include "TimerMacros.h"
+#include "RegisterMacros.h"
+#include "Profile.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -55,18 +57,43 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static struct {
-    uint16_t    CaptLow;                            // Timer at low  transition
-    uint16_t    CaptHigh;                           // Timer at high transition
-    uint16_t    FreqTotal;                          // Total     ticks in counted cycles
-    uint16_t    FreqCycles;                         // Number of cycles in totals
-    uint16_t    PWMTotal;                           // Total PWM ticks in counted cycles
-    uint16_t    PWM;                                // Calculated PWM  value
-    uint16_t    Freq;                               // Calculated Freq value
-    int8_t      SkipCount;                          // Cycles until next measurement
-    bool        FreqEnd;                            // TRUE if next meas is end of FREQ
+#define GOT_NONE        0                           // Waiting for a rising edge
+#define GOT_RISE        1                           // Waiting for a falling edge
+#define GOT_FALL        2                           // Waiting for the rising edge ending the cycle
+
+typedef struct {
+    uint32_t    RiseTime;                           // Time of last rising  edge
+    uint32_t    FallTime;                           // Time of last falling edge
+    uint32_t    PeriodSum;                          // Total period    of counted cycles
+    uint32_t    HighSum;                            // Total high time of counted cycles
+    uint32_t    PeriodMin;                          // Shortest period in counted cycles
+    uint32_t    PeriodMax;                          // Longest  period in counted cycles
+    uint16_t    Cycles;                             // Number of cycles in totals
+    uint16_t    Missed;                             // Edges lost
+    uint8_t     State;                              // Edges seen in current cycle
+    } PWM_CHAN;
+
+//
+// Written by the ISRs
+//
+static volatile struct {
+    PWM_CHAN    Chan[PWM_NUM_CHANNELS];             // Per-channel totals
+    uint16_t    TimerExt;                           // Upper 16 bits of timestamp
+#ifdef PWM_PCI_CHANNELS
+    uint8_t     PCIPrev;                            // Pin levels at last PCI
+#endif
     } PWM NOINIT;
 
+//
+// Used by PWMUpdate
+//
+static struct {
+    PWM_STATS   Stats[PWM_NUM_CHANNELS];            // Calculated values
+    uint16_t    Idle[PWM_NUM_CHANNELS];             // Ticks without a complete cycle
+    } PWMResult NOINIT;
+
+#define PWM_TIMEOUT_TICKS   (PWM_TIMEOUT_MS/MS_PER_TICK)
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Setup some port designations
@@ -76,23 +103,45 @@ static struct {
 #define PWM_TIMER_ID    1
 #define PRTIMx          _PRTIM(PWM_TIMER_ID)
 #define PWM_ISR         _TCAPT_VECT(PWM_TIMER_ID)
+#define OFLO_ISR        _TOVF_VECT(PWM_TIMER_ID)
 
 #define TCCRAx          _TCCRA(PWM_TIMER_ID)
 #define TCCRBx          _TCCRB(PWM_TIMER_ID)
 #define TIMSKx          _TIMSK(PWM_TIMER_ID)
+#define TIFRx           _TIFR(PWM_TIMER_ID)
 #define TCNTx           _TCNT(PWM_TIMER_ID)
 #define ICIEx           _ICIE(PWM_TIMER_ID)
+#define TOIEx           _TOIE(PWM_TIMER_ID)
+#define ICFx            _ICF(PWM_TIMER_ID)
+#define TOVx            _TOV(PWM_TIMER_ID)
 #define ICRx            _ICR(PWM_TIMER_ID)
 
+#ifdef PWM_NOISE_CANCEL
 #define PWM_FILTER      _PIN_MASK(_ICNC(PWM_TIMER_ID))
-#define PWM_MODE        _PIN_MASK(_CS0(PWM_TIMER_ID))
+#else
+#define PWM_FILTER      0
+#endif
 
-#define RISING_EDGE     _ICES(PWM_TIMER_ID)
+#define PWM_MODE        _PIN_MASK(_CS0(PWM_TIMER_ID))  // clk I/O /1
 
-#define DISABLE_INT     _CLR_BIT(TIMSKx,ICIEx)
-#define ENABLE_INT      _SET_BIT(TIMSKx,ICIEx)
+#define RISING_EDGE     _ICES(PWM_TIMER_ID)
 
-#define SKIP_MAX        10
+#if defined(_AVR_IOM1284P_H_)
+#define ICP_PORT        D                           // ICP1 == PD6
+#define ICP_PIN         6
+#elif defined(_AVR_IOM2560_H_)
+#define ICP_PORT        D                           // ICP1 == PD4
+#define ICP_PIN         4
+#else
+#define ICP_PORT        B                           // ICP1 == PB0
+#define ICP_PIN         0
+#endif
+
+#ifdef PWM_PCI_CHANNELS
+#define PCIEx           _PCIE(PWM_PCI_NUM)
+#define PCIMSKx         _PCIMSK(PWM_PCI_NUM)
+#define PCI_ISR         _PCI_VECT(PWM_PCI_NUM)
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -105,20 +154,56 @@ static struct {
 //
 void PWMInit(void) {
 
-    memset(&PWM,0,sizeof(PWM));
-
-    PWM.SkipCount = SKIP_MAX;
+    memset((void *) &PWM,0,sizeof(PWM));
+    memset(&PWMResult,0,sizeof(PWMResult));
 
     _CLR_BIT(PRR,PRTIMx);           // Powerup the clock
 
+    _CLR_BIT(_DDR(ICP_PORT),ICP_PIN);   // ICP is an input
+
     //
-    // Setup the timer as free running
+    // Setup the timer as free running at full clock speed, looking for a
+    //   rising edge first.
     //
     TCCRAx = 0;                     // Normal counter
-    TCCRBx = PWM_MODE;
+    TCCRBx = PWM_MODE | PWM_FILTER | _PIN_MASK(RISING_EDGE);
     TCNTx  = 0;
 
-    ENABLE_INT;
+    TIFRx  = _PIN_MASK(ICFx) | _PIN_MASK(TOVx);     // Clear stale flags
+    TIMSKx = _PIN_MASK(ICIEx) | _PIN_MASK(TOIEx);   // Allow interrupts
+
+#ifdef PWM_PCI_CHANNELS
+    _CLR_MASK(_DDR(PWM_PCI_PORT),PWM_PCI_MASK);     // PCI pins are inputs
+
+    PWM.PCIPrev = _PIN(PWM_PCI_PORT);
+
+    _SET_MASK(PCIMSKx,PWM_PCI_MASK);
+    _SET_BIT(PCICR,PCIEx);
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMPinHigh - Return current level of channel input
+//
+// Inputs:      Channel to check
+//
+// Outputs:     TRUE if input is high
+//
+static bool PWMPinHigh(uint8_t Channel) {
+
+    if( Channel == 0 )
+        return _BIT_ON(_PIN(ICP_PORT),ICP_PIN);
+
+#ifdef PWM_PCI_CHANNELS
+    for( uint8_t Bit = 1; Bit; Bit <<= 1 ) {
+        if( (PWM_PCI_MASK & Bit) && --Channel == 0 )
+            return _PIN(PWM_PCI_PORT) & Bit;
+        }
+#endif
+
+    return false;
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -131,33 +216,84 @@ void PWMInit(void) {
 // Outputs:     None.
 //
 void PWMUpdate(void) {
-    uint16_t    FreqLocal;
-    uint16_t    PWMLocal;
-    uint16_t    CyclesLocal;
-
-    DISABLE_INT;
 
-    FreqLocal   = PWM.FreqTotal;
-    PWMLocal    = PWM.PWMTotal;
-    CyclesLocal = PWM.FreqCycles;
-
-    PWM.FreqTotal  = 0;
-    PWM.PWMTotal   = 0;
-    PWM.FreqCycles = 0;
+    for( uint8_t Channel = 0; Channel < PWM_NUM_CHANNELS; Channel++ ) {
+        volatile PWM_CHAN *Chan  = &PWM.Chan[Channel];
+        PWM_STATS         *Stats = &PWMResult.Stats[Channel];
+        uint8_t  SaveSREG = SREG;
+
+        //
+        // Take the totals and start new ones
+        //
+        cli();
+        uint32_t PeriodSum = Chan->PeriodSum;
+        uint32_t HighSum   = Chan->HighSum;
+        uint32_t PeriodMin = Chan->PeriodMin;
+        uint32_t PeriodMax = Chan->PeriodMax;
+        uint16_t Cycles    = Chan->Cycles;
+        uint16_t Missed    = Chan->Missed;
+
+        Chan->PeriodSum = 0;
+        Chan->HighSum   = 0;
+        Chan->PeriodMax = 0;
+        Chan->Cycles    = 0;
+        SREG = SaveSREG;
+
+        Stats->Missed = Missed;
+
+        if( Cycles ) {
+            Stats->Period    = (PeriodSum + Cycles/2)/Cycles;
+            Stats->High      = (HighSum   + Cycles/2)/Cycles;
+            Stats->PeriodMin = PeriodMin;
+            Stats->PeriodMax = PeriodMax;
+            Stats->Duty      = ((uint64_t) HighSum*1000 + PeriodSum/2)/PeriodSum;
+            Stats->Cycles    = Cycles;
+            PWMResult.Idle[Channel] = 0;
+            continue;
+            }
+
+        //
+        // If no cycles for a while the input has stopped, either high or low.
+        //   Otherwise keep the last values - slow inputs don't finish a cycle
+        //   every tick.
+        //
+        if( PWMResult.Idle[Channel] < PWM_TIMEOUT_TICKS && 
+            ++PWMResult.Idle[Channel] < PWM_TIMEOUT_TICKS )
+            continue;
+
+        Stats->Period    = 0;
+        Stats->High      = 0;
+        Stats->PeriodMin = 0;
+        Stats->PeriodMax = 0;
+        Stats->Duty      = PWMPinHigh(Channel) ? 1000 : 0;
+        Stats->Cycles    = 0;
+        }
+    }
 
-    ENABLE_INT;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMGetStats - Return measurements for one channel
+//
+// PWMUpdate() may be called from the timer interrupt, so the values are read
+//   with interrupts off.
+//
+// Inputs:      Channel to return (0 == ICP1)
+//              Ptr to stats to fill in
+//
+// Outputs:     None.
+//
+void PWMGetStats(uint8_t Channel,PWM_STATS *Stats) {
+    uint8_t SaveSREG = SREG;
 
-    //
-    // If system is off, no frequency or PWM will be seen from last update
-    //
-    if( FreqLocal == 0 ) {
-        PWM.PWM  = 0;
-        PWM.Freq = 0;
-        }
-    else {
-        PWM.PWM  = ((uint32_t) PWMLocal*1000)/((uint32_t) FreqLocal);
-        PWM.Freq = ((uint32_t) F_CPU*CyclesLocal)/((uint32_t) FreqLocal);
+    if( Channel >= PWM_NUM_CHANNELS ) {
+        memset(Stats,0,sizeof(*Stats));
+        return;
         }
+
+    cli();
+    *Stats = PWMResult.Stats[Channel];
+    SREG   = SaveSREG;
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -169,7 +305,13 @@ void PWMUpdate(void) {
 //
 // Outputs:     Measured PWM, in % x 10 (ex: 35% -> 350)
 //
-uint16_t GetPWM(void) { return PWM.PWM; }
+uint16_t GetPWM(void) { 
+    PWM_STATS Stats;
+
+    PWMGetStats(0,&Stats);
+
+    return Stats.Duty;
+    }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -179,9 +321,65 @@ uint16_t GetPWM(void) { return PWM.PWM; }
 //
 // Inputs:      None.
 //
-// Outputs:     Currently measured frequency
+// Outputs:     Currently measured frequency, in Hz
 //
-uint16_t GetPWMFreq(void) { return PWM.Freq; }
+uint16_t GetPWMFreq(void) { 
+    PWM_STATS Stats;
+
+    PWMGetStats(0,&Stats);
+
+    if( Stats.Period == 0 )
+        return 0;
+
+    uint32_t Freq = (F_CPU + Stats.Period/2)/Stats.Period;
+
+    return Freq > 0xFFFF ? 0xFFFF : Freq;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMEdge - Process one edge of a channel
+//
+// A cycle is rising edge to rising edge, and the high time is from the rising
+//   edge to the falling edge between them.
+//
+// Inputs:      Channel to process
+//              Timestamp of edge
+//              TRUE if rising edge
+//
+// Outputs:     None.
+//
+static inline void PWMEdge(volatile PWM_CHAN *Chan,uint32_t Time,bool Rising) {
+
+    if( !Rising ) {
+        if( Chan->State == GOT_RISE ) {
+            Chan->FallTime = Time;
+            Chan->State    = GOT_FALL;
+            }
+        return;
+        }
+
+    if( Chan->State == GOT_FALL ) {
+        uint32_t Period = Time - Chan->RiseTime;
+
+        Chan->PeriodSum += Period;
+        Chan->HighSum   += Chan->FallTime - Chan->RiseTime;
+
+        if( Chan->Cycles == 0 || Period < Chan->PeriodMin )
+            Chan->PeriodMin = Period;
+
+        if( Period > Chan->PeriodMax )
+            Chan->PeriodMax = Period;
+
+        if( Chan->Cycles < 0xFFFF )
+            Chan->Cycles++;
+        }
+
+    Chan->RiseTime = Time;
+    Chan->State    = GOT_RISE;
+    }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -189,56 +387,109 @@ uint16_t GetPWMFreq(void) { return PWM.Freq; }
 //
 // TIMERx_CAPT_vect - Input capture causes an interrupt
 //
+// Every edge is captured: the edge select is flipped after each one. The
+//   overflow flag is checked as in Capture.c, in case an overflow just before
+//   the edge hasn't been serviced yet.
+//
+// Runs with interrupts off, so the overflow ISR can't change TimerExt in the
+//   middle of this.
+//
 // Inputs:      None. (ISR)
 //
 // Outputs:     None.
 //
-ISR(TIMER1_CAPT_vect,ISR_NOBLOCK) {
+ISR(PWM_ISR) {
+    uint16_t Count  = ICRx;
+    uint16_t Ext    = PWM.TimerExt;
+    bool     Rising = _BIT_ON(TCCRBx,RISING_EDGE);
+    bool     High;
 
-    //////////////////////////////////////////////////////////////////////////////////////
-    //
-    // Save CPU time by only measuring 1-in-10 cycles
-    //
-    if( --PWM.SkipCount > 0 )
-        return;
+#if PWM_TIMER_ID == PROFILE_TIMER_ID
+    PROFILE_ISR_AT(PROFILE_PWM,Count);      // Latency from the edge
+#else
+    PROFILE_ISR(PROFILE_PWM);
+#endif
+
+    if( _BIT_ON(TIFRx,TOVx) && Count < 0x8000 )
+        Ext++;
 
-    //////////////////////////////////////////////////////////////////////////////////////
-    //
-    // FALLING EDGE
     //
-    // Note the ICP of the falling edge. Set next round to interrupt on rising edge.
+    // Look for the opposite edge next. Changing the edge can set ICF, so clear
+    //   it afterwards.
     //
-    if( _BIT_OFF(TCCRBx,RISING_EDGE) ) {
-        PWM.CaptLow = ICRx;
-        PWM.FreqEnd = false;
-        _SET_BIT(TCCRBx,RISING_EDGE);
-        return;
-        }
+    TCCRBx ^= _PIN_MASK(RISING_EDGE);
+    TIFRx   = _PIN_MASK(ICFx);
 
-    //////////////////////////////////////////////////////////////////////////////////////
     //
-    // 1ST RISING EDGE
+    // The input should still be at the level of the edge just captured. If not,
+    //   the next edge came before the edge select was changed, and is lost. Go
+    //   back to the original edge select (that's the next edge to come) and
+    //   start over with the next full cycle.
     //
-    // Note the ICP of the rising edge. Set next round to interrupt on rising edge.
-    //
-    if( !PWM.FreqEnd ) {
-        PWM.CaptHigh = ICRx;
-        PWM.FreqEnd  = true;
+    High = _BIT_ON(_PIN(ICP_PORT),ICP_PIN);
+
+    if( High != Rising ) {
+        TCCRBx ^= _PIN_MASK(RISING_EDGE);
+        TIFRx   = _PIN_MASK(ICFx);
+        PWM.Chan[0].Missed++;
+        PWM.Chan[0].State = GOT_NONE;
         return;
         }
 
-    //////////////////////////////////////////////////////////////////////////////////////
-    //
-    // 2ND RISING EDGE
-    //
-    // Total the PWM and FREQ counts
-    //
-    uint16_t    FreqCount = ICRx - PWM.CaptHigh;
+    PWMEdge(&PWM.Chan[0],((uint32_t) Ext << 16) | Count,Rising);
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMERx_OVF_vect - Overflow timer count
+//
+// Just increment the extended word, making an equivalent 32-bit timer
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(OFLO_ISR) { PWM.TimerExt++; }
+
+
+#ifdef PWM_PCI_CHANNELS
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PCINTx_vect - Pin change on one of the PCI channels
+//
+// The timer is read first thing, to keep the latency as short as possible.
+//   Several pins may have changed at once; each is a separate edge with the
+//   same timestamp.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(PCI_ISR) {
+    uint16_t Count   = TCNTx;
+    uint16_t Ext     = PWM.TimerExt;
+    uint8_t  Pins    = _PIN(PWM_PCI_PORT);
+    uint8_t  Changed = (Pins ^ PWM.PCIPrev) & PWM_PCI_MASK;
+    volatile PWM_CHAN *Chan = &PWM.Chan[1];
+
+    if( _BIT_ON(TIFRx,TOVx) && Count < 0x8000 )
+        Ext++;
+
+    PWM.PCIPrev = Pins;
 
-    PWM.FreqTotal += FreqCount;
-    PWM.PWMTotal  += FreqCount - (PWM.CaptHigh - PWM.CaptLow);
-    PWM.FreqCycles++;
-    PWM.SkipCount = SKIP_MAX;
+    uint32_t Time = ((uint32_t) Ext << 16) | Count;
 
-    _CLR_BIT(TCCRBx,RISING_EDGE);
+    for( uint8_t Bit = 1; Bit; Bit <<= 1 ) {
+        if( !(PWM_PCI_MASK & Bit) )
+            continue;
+
+        if( Changed & Bit )
+            PWMEdge(Chan,Time,Pins & Bit);
+
+        Chan++;
+        }
     }
+#endif
@@ -13,20 +13,24 @@
 //      //
 //      // On Circuitboard
 //      //
-//      Hook up a PWM Oscillator to ICP (PortB.0)
+//      Hook up a PWM signal to ICP1 (PortB.0)
+//
+//      ...and optionally, more PWM signals to pins of one port, using
+//        pin change interrupts
 //
 //      //////////////////////////////////////
 //      //
-//      // In Timer.h
+//      // In PWM.h
 //      //
-//      ...Choose a timer                  (Default: Timer2)
-//      ...Choose Polled or interrupt mode (Default: Interrupt)
-//      ...Choose tick duration            (Default: 40ms)
+//      ...Choose noise canceller          (Default: Off)
+//      ...Choose pin change channels      (Default: None)
 //
 //      //////////////////////////////////////
 //      //
 //      // In Main.c
 //      //
+//      PWM_STATS   Stats;
+//
 //      TimerInit();
 //      PWMInit();                          // Called once at startup
 //          :
@@ -35,16 +39,44 @@
 //          while( !TimerUpdate() )
 //              sleep_cpu();                // Wait for tick to happen
 //
-//          PWMUpdate();                    // Update frequency calculations
+//          PWMUpdate();                    // Update PWM calculations
+//
+//          uint16_t PWM = GetPWM();        // Get duty cycle of channel 0
 //
-//          uint16_t PWM = GetPWM();        // Get PWM over last second
+//          PWMGetStats(1,&Stats);          // Get everything for channel 1
 //          }
 //
 //  DESCRIPTION
 //
 //      PWM processing
 //
-//  EXAMPLE
+//      Measures the period, high time and duty cycle of PWM inputs, along
+//        with the spread in period (jitter).
+//
+//      Timer1 runs free at the full CPU clock, extended to 32 bits by counting
+//        overflows, and every edge of every input is timestamped. Nothing is
+//        skipped, so each measurement covers every cycle since the last one.
+//        Periods up to PWM_TIMEOUT_MS can be measured.
+//
+//      Channel 0 is ICP1, timestamped by the input capture hardware, so there
+//        is no timing jitter from interrupt latency. The capture edge is
+//        flipped after each edge; if the input has already changed again by
+//        then, the lost edge is counted and the channel resyncs.
+//
+//      Channels 1 and up are pins on one port (PWM_PCI_MASK), using the pin
+//        change interrupt. These are timestamped when the ISR reads the timer,
+//        so other interrupts add a few uS of jitter. Two changes on one pin
+//        before the ISR runs aren't seen at all.
+//
+//      Each call to PWMUpdate() gathers the cycles completed since the last
+//        call, and computes averages and min/max. If no cycle completes in
+//        PWM_TIMEOUT_MS, the input is taken to be stopped and the duty cycle
+//        is 0 or 100% depending on the pin level.
+//
+//  NOTES
+//
+//      Uses Timer1 exclusively: this module can't be used together with
+//        Capture.c, or with FREQ_RECIPROCAL in Freq.h.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -73,19 +105,72 @@
 #ifndef PWM_H
 #define PWM_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "Timer.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// The only ICP on the Arduino is on Timer1
+// The only ICP on the Arduino is on Timer1, which is always channel 0.
 //
 
 //
-// No user configurable options
+// Noise canceller depends on the next definition.
+//
+// Defined (ie - uncommented) means enable the input capture noise canceller on
+//   channel 0, which ignores glitches shorter than 4 CPU clocks.
+//
+//#define PWM_NOISE_CANCEL
+
+//
+// Pin change channels depend on the next definition.
+//
+// Defined (ie - uncommented) means also measure the pins in PWM_PCI_MASK of
+//   PWM_PCI_PORT, as channels 1 and up (lowest numbered pin first).
+//
+//#define PWM_PCI_CHANNELS
+
+#define PWM_PCI_PORT    D               // Port of PCI inputs
+#define PWM_PCI_NUM     2               // PCI group associated with port
+#define PWM_PCI_MASK    0x0C            // PD2 and PD3
+
+#define PWM_TIMEOUT_MS  1000            // No cycles for this long means stopped
+
+//
+// End of user configurable options
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#define _BIT_COUNT(_m_)     ((((_m_) >> 0) & 1) + (((_m_) >> 1) & 1) +   \
+                             (((_m_) >> 2) & 1) + (((_m_) >> 3) & 1) +   \
+                             (((_m_) >> 4) & 1) + (((_m_) >> 5) & 1) +   \
+                             (((_m_) >> 6) & 1) + (((_m_) >> 7) & 1))
+
+#ifdef PWM_PCI_CHANNELS
+#define PWM_NUM_CHANNELS    (1 + _BIT_COUNT(PWM_PCI_MASK))
+#else
+#define PWM_NUM_CHANNELS    1
+#endif
+
+typedef struct {
+    uint32_t    Period;                             // Average period,      in CPU cycles
+    uint32_t    High;                               // Average high time,   in CPU cycles
+    uint32_t    PeriodMin;                          // Shortest period seen
+    uint32_t    PeriodMax;                          // Longest  period seen
+    uint16_t    Duty;                               // Duty cycle, in % x 10
+    uint16_t    Cycles;                             // Number of cycles in measurement
+    uint16_t    Missed;                             // Edges lost since PWMInit()
+    } PWM_STATS;
+
+#define PWM_HZ              F_CPU                   // Period counts per second
+#define PWM_TO_NS(_c_)      ((_c_)*(1000000000UL/PWM_HZ))
+#define PWM_TO_US(_c_)      ((_c_)/(PWM_HZ/1000000UL))
+#define PWM_JITTER(_s_)     ((_s_).PeriodMax - (_s_).PeriodMin)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -104,6 +189,8 @@ void PWMInit(void);
 //
 // PWMUpdate - Update PWM measurement
 //
+// Call once per timer tick.
+//
 // Inputs:      None.
 //
 // Outputs:     None.
@@ -111,12 +198,31 @@ void PWMInit(void);
 void PWMUpdate(void);
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMGetStats - Return measurements for one channel
+//
+// The values are from the cycles completed between the last two calls to
+//   PWMUpdate(), or from the most recent cycle if the input is slower than
+//   that. PeriodMax - PeriodMin (PWM_JITTER) is the peak-to-peak jitter.
+//
+// Inputs:      Channel to return (0 == ICP1)
+//              Ptr to stats to fill in
+//
+// Outputs:     None.
+//
+void PWMGetStats(uint8_t Channel,PWM_STATS *Stats);
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // GetPWM     - Return currently measured PWM
 // GetPWMFreq - Return currently measured Frequency
 //
+// These are for channel 0 (ICP1).
+//
 // Inputs:      None.
 //
 // Outputs:     Measured PWM, in % x 10 (ex: 35% -> 350)
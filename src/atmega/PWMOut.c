@@ -0,0 +1,430 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      PWMOut.c
+//
+//  DESCRIPTION
+//
+//      Hardware PWM output
+//
+//      Setup timers for PWM output on the OCnA and OCnB pins.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "PWMOut.h"
+#include "PortMacros.h"
+#include "TimerMacros.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//
+// Not NOINIT: there's no single init call, and Top == 0 must mean "not setup"
+//   for timers that haven't been through PWMOutInit().
+//
+static struct {
+    uint16_t    Top[3];                             // Top count, per timer
+    uint8_t     Mode[3];                            // PWMOUT_FAST or PWMOUT_PHASE
+    } PWMOut;
+
+//
+// Prescaler choices, in order of CS bit value
+//
+static const uint16_t Prescale01[] = { 1, 8, 64, 256, 1024 };
+static const uint16_t Prescale2[]  = { 1, 8, 32, 64, 128, 256, 1024 };
+
+//
+// Output pins
+//
+#if defined(_AVR_IOM1284P_H_)
+#define OC0A_PORT       B                           // OC0A == PB3
+#define OC0A_PIN        3
+#define OC0B_PORT       B                           // OC0B == PB4
+#define OC0B_PIN        4
+#define OC1A_PORT       D                           // OC1A == PD5
+#define OC1A_PIN        5
+#define OC1B_PORT       D                           // OC1B == PD4
+#define OC1B_PIN        4
+#define OC2A_PORT       D                           // OC2A == PD7
+#define OC2A_PIN        7
+#define OC2B_PORT       D                           // OC2B == PD6
+#define OC2B_PIN        6
+#define CPUPRR          PRR0
+#elif defined(_AVR_IOM2560_H_)
+#define OC0A_PORT       B                           // OC0A == PB7
+#define OC0A_PIN        7
+#define OC0B_PORT       G                           // OC0B == PG5
+#define OC0B_PIN        5
+#define OC1A_PORT       B                           // OC1A == PB5
+#define OC1A_PIN        5
+#define OC1B_PORT       B                           // OC1B == PB6
+#define OC1B_PIN        6
+#define OC2A_PORT       B                           // OC2A == PB4
+#define OC2A_PIN        4
+#define OC2B_PORT       H                           // OC2B == PH6
+#define OC2B_PIN        6
+#define CPUPRR          PRR0
+#else
+#define OC0A_PORT       D                           // OC0A == PD6
+#define OC0A_PIN        6
+#define OC0B_PORT       D                           // OC0B == PD5
+#define OC0B_PIN        5
+#define OC1A_PORT       B                           // OC1A == PB1
+#define OC1A_PIN        1
+#define OC1B_PORT       B                           // OC1B == PB2
+#define OC1B_PIN        2
+#define OC2A_PORT       B                           // OC2A == PB3
+#define OC2A_PIN        3
+#define OC2B_PORT       D                           // OC2B == PD3
+#define OC2B_PIN        3
+#define CPUPRR          PRR
+#endif
+
+//
+// Mode bits. 8-bit timers count to 0xFF; Timer1 counts to ICR1.
+//
+#define FAST8_A(_x_)    (_PIN_MASK(_WGM1(_x_)) | _PIN_MASK(_WGM0(_x_)))    // Mode 3
+#define PHASE8_A(_x_)   (_PIN_MASK(_WGM0(_x_)))                             // Mode 1
+
+#define FAST16_A        (_PIN_MASK(_WGM1(1)))                               // Mode 14
+#define FAST16_B        (_PIN_MASK(_WGM3(1)) | _PIN_MASK(_WGM2(1)))
+#define PHASE16_A       0                                                   // Mode 8
+#define PHASE16_B       (_PIN_MASK(_WGM3(1)))
+
+#define CS_MASK         0x07                        // Clock select bits in TCCRxB
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutPrescale8 - Choose prescaler for 8-bit timer
+//
+// Inputs:      Table of prescale values for timer
+//              Number of entries in table
+//              Timer counts per period
+//              Frequency wanted
+//
+// Outputs:     CS bit value of prescaler giving nearest frequency
+//
+static uint8_t PWMOutPrescale8(const uint16_t *Table,uint8_t nTable,uint16_t Counts,uint32_t Freq) {
+    uint8_t  Best     = 0;
+    uint32_t BestDiff = 0xFFFFFFFF;
+
+    for( uint8_t i=0; i<nTable; i++ ) {
+        uint32_t Actual = F_CPU/((uint32_t) Table[i]*Counts);
+        uint32_t Diff   = Actual > Freq ? Actual - Freq : Freq - Actual;
+
+        if( Diff < BestDiff ) {
+            Best     = i;
+            BestDiff = Diff;
+            }
+        }
+
+    return Best+1;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutInit - Setup a timer for PWM output
+//
+// Inputs:      Timer to use (0, 1 or 2)
+//              PWMOUT_FAST or PWMOUT_PHASE
+//              Frequency wanted, in Hz
+//
+// Outputs:     Top count (resolution is Top+1 steps), zero if frequency can't
+//                be done or the timer isn't enabled in PWMOut.h
+//
+uint16_t PWMOutInit(uint8_t Timer,uint8_t Mode,uint32_t Freq) {
+
+    if( Timer >= NUMOF(PWMOut.Top) || Freq == 0 )
+        return 0;
+
+    PWMOut.Top [Timer] = 0;
+    PWMOut.Mode[Timer] = Mode;
+
+    switch(Timer) {
+
+#ifdef PWMOUT_TIMER0
+        case 0:
+            _CLR_BIT(CPUPRR,_PRTIM(0));             // Powerup the clock
+
+            _TCCRB(0) = 0;                          // Stop the clock
+            _TCCRA(0) = Mode == PWMOUT_FAST ? FAST8_A(0) : PHASE8_A(0);
+            _OCRA(0)  = 0;
+            _OCRB(0)  = 0;
+            _TCNT(0)  = 0;
+            _TCCRB(0) = PWMOutPrescale8(Prescale01,NUMOF(Prescale01),
+                                        Mode == PWMOUT_FAST ? 256 : 510,Freq);
+            PWMOut.Top[0] = 0xFF;
+            break;
+#endif
+
+#ifdef PWMOUT_TIMER1
+        case 1: {
+            uint8_t  Scale;
+            uint32_t Top = 0;
+
+            //
+            // Smallest prescaler that fits gives the most resolution
+            //
+            for( Scale=0; Scale<NUMOF(Prescale01); Scale++ ) {
+                if( Mode == PWMOUT_FAST ) Top = (F_CPU + Prescale01[Scale]*Freq/2)/(Prescale01[Scale]*Freq) - 1;
+                else                      Top = (F_CPU + Prescale01[Scale]*Freq  )/(Prescale01[Scale]*Freq*2);
+
+                if( Top <= 0xFFFF )
+                    break;
+                }
+
+            if( Scale >= NUMOF(Prescale01) || Top < 3 )
+                return 0;                           // Too slow or too fast
+
+            _CLR_BIT(CPUPRR,_PRTIM(1));             // Powerup the clock
+
+            uint8_t SaveSREG = SREG;                // 16-bit registers share TEMP
+            cli();
+            _TCCRB(1) = 0;                          // Stop the clock
+            _TCCRA(1) = Mode == PWMOUT_FAST ? FAST16_A : PHASE16_A;
+            _ICR(1)   = Top;
+            _OCRA(1)  = 0;
+            _OCRB(1)  = 0;
+            _TCNT(1)  = 0;
+            _TCCRB(1) = (Mode == PWMOUT_FAST ? FAST16_B : PHASE16_B) | (Scale+1);
+            SREG      = SaveSREG;
+
+            PWMOut.Top[1] = Top;
+            break;
+            }
+#endif
+
+#ifdef PWMOUT_TIMER2
+        case 2:
+            _CLR_BIT(CPUPRR,_PRTIM(2));             // Powerup the clock
+
+            _TCCRB(2) = 0;                          // Stop the clock
+            _TCCRA(2) = Mode == PWMOUT_FAST ? FAST8_A(2) : PHASE8_A(2);
+            _OCRA(2)  = 0;
+            _OCRB(2)  = 0;
+            _TCNT(2)  = 0;
+            _TCCRB(2) = PWMOutPrescale8(Prescale2,NUMOF(Prescale2),
+                                        Mode == PWMOUT_FAST ? 256 : 510,Freq);
+            PWMOut.Top[2] = 0xFF;
+            break;
+#endif
+
+        default:
+            return 0;
+        }
+
+    return PWMOut.Top[Timer];
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutSet - Set duty cycle of output
+//
+// Inputs:      Output to set (ie - PWMOUT_1A)
+//              Duty cycle, in % x 10 (ex: 35% -> 350)
+//
+// Outputs:     None.
+//
+void PWMOutSet(uint8_t Output,uint16_t Duty) {
+    uint16_t Top = PWMOutGetTop(PWMOUT_TIMER(Output));
+
+    if( Duty > PWMOUT_MAX )
+        Duty = PWMOUT_MAX;
+
+    PWMOutSetRaw(Output,((uint32_t) Duty*Top + PWMOUT_MAX/2)/PWMOUT_MAX);
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutSetRaw - Set compare value of output
+//
+// The compare registers are double buffered by the hardware, so the new value
+//   starts with the next period. The only unbuffered change is connecting or
+//   disconnecting the pin for 0% in fast mode.
+//
+// Inputs:      Output to set (ie - PWMOUT_1A)
+//              Compare value, 0 to Top
+//
+// Outputs:     None.
+//
+void PWMOutSetRaw(uint8_t Output,uint16_t Count) {
+    uint8_t Timer = PWMOUT_TIMER(Output);
+    uint16_t Top  = PWMOutGetTop(Timer);
+
+    if( Top == 0 )
+        return;
+
+    if( Count > Top )
+        Count = Top;
+
+    //
+    // Connect the pin (non-inverting) unless this is a true 0% in fast mode
+    //
+    bool Connect = Count > 0 || PWMOut.Mode[Timer] == PWMOUT_PHASE;
+
+    switch(Output) {
+
+#ifdef PWMOUT_TIMER0
+        case PWMOUT_0A:
+            _OCRA(0) = Count;
+            _CLR_BIT(_PORT(OC0A_PORT),OC0A_PIN);
+            _SET_BIT(_DDR (OC0A_PORT),OC0A_PIN);
+            if( Connect ) _SET_BIT(_TCCRA(0),_COMA1(0))
+            else          _CLR_BIT(_TCCRA(0),_COMA1(0));
+            break;
+
+        case PWMOUT_0B:
+            _OCRB(0) = Count;
+            _CLR_BIT(_PORT(OC0B_PORT),OC0B_PIN);
+            _SET_BIT(_DDR (OC0B_PORT),OC0B_PIN);
+            if( Connect ) _SET_BIT(_TCCRA(0),_COMB1(0))
+            else          _CLR_BIT(_TCCRA(0),_COMB1(0));
+            break;
+#endif
+
+#ifdef PWMOUT_TIMER1
+        case PWMOUT_1A:
+        case PWMOUT_1B: {
+            uint8_t SaveSREG = SREG;                // 16-bit registers share TEMP
+
+            cli();
+            if( Output == PWMOUT_1A ) _OCRA(1) = Count;
+            else                      _OCRB(1) = Count;
+            SREG = SaveSREG;
+
+            if( Output == PWMOUT_1A ) {
+                _CLR_BIT(_PORT(OC1A_PORT),OC1A_PIN);
+                _SET_BIT(_DDR (OC1A_PORT),OC1A_PIN);
+                if( Connect ) _SET_BIT(_TCCRA(1),_COMA1(1))
+                else          _CLR_BIT(_TCCRA(1),_COMA1(1));
+                }
+            else {
+                _CLR_BIT(_PORT(OC1B_PORT),OC1B_PIN);
+                _SET_BIT(_DDR (OC1B_PORT),OC1B_PIN);
+                if( Connect ) _SET_BIT(_TCCRA(1),_COMB1(1))
+                else          _CLR_BIT(_TCCRA(1),_COMB1(1));
+                }
+            break;
+            }
+#endif
+
+#ifdef PWMOUT_TIMER2
+        case PWMOUT_2A:
+            _OCRA(2) = Count;
+            _CLR_BIT(_PORT(OC2A_PORT),OC2A_PIN);
+            _SET_BIT(_DDR (OC2A_PORT),OC2A_PIN);
+            if( Connect ) _SET_BIT(_TCCRA(2),_COMA1(2))
+            else          _CLR_BIT(_TCCRA(2),_COMA1(2));
+            break;
+
+        case PWMOUT_2B:
+            _OCRB(2) = Count;
+            _CLR_BIT(_PORT(OC2B_PORT),OC2B_PIN);
+            _SET_BIT(_DDR (OC2B_PORT),OC2B_PIN);
+            if( Connect ) _SET_BIT(_TCCRA(2),_COMB1(2))
+            else          _CLR_BIT(_TCCRA(2),_COMB1(2));
+            break;
+#endif
+
+        default:
+            break;
+        }
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutGetTop - Return top count of timer
+//
+// Inputs:      Timer to check
+//
+// Outputs:     Top count, zero if timer not setup
+//
+uint16_t PWMOutGetTop(uint8_t Timer) {
+
+    if( Timer >= NUMOF(PWMOut.Top) )
+        return 0;
+
+    return PWMOut.Top[Timer];
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutStop - Stop PWM output on a timer
+//
+// Inputs:      Timer to stop
+//
+// Outputs:     None.
+//
+void PWMOutStop(uint8_t Timer) {
+
+    switch(Timer) {
+
+#ifdef PWMOUT_TIMER0
+        case 0:
+            _TCCRA(0) = 0;                          // Disconnect pins, port drives low
+            _TCCRB(0) = 0;                          // Stop the clock
+            break;
+#endif
+
+#ifdef PWMOUT_TIMER1
+        case 1:
+            _TCCRA(1) = 0;
+            _TCCRB(1) = 0;
+            break;
+#endif
+
+#ifdef PWMOUT_TIMER2
+        case 2:
+            _TCCRA(2) = 0;
+            _TCCRB(2) = 0;
+            break;
+#endif
+
+        default:
+            return;
+        }
+
+    PWMOut.Top[Timer] = 0;
+    }
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      PWMOut.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In PWMOut.h
+//      //
+//      ...Choose timers to use            (Default: Timer0 and Timer1)
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c
+//      //
+//      PWMOutInit(1,PWMOUT_PHASE,20000);   // Timer1, 20 KHz, phase correct
+//      PWMOutInit(0,PWMOUT_FAST ,1000);    // Timer0, about 1 KHz, fast PWM
+//
+//      PWMOutSet(PWMOUT_1A,250);           // OC1A at 25.0%
+//      PWMOutSet(PWMOUT_0B,900);           // OC0B at 90.0%
+//
+//  DESCRIPTION
+//
+//      Hardware PWM output
+//
+//      The timer hardware generates the PWM on the OCnA and OCnB pins, so once
+//        a duty cycle is set there is no CPU cost at all: no interrupts, and
+//        nothing to call.
+//
+//      The OCR registers are double buffered in the PWM modes. A new duty
+//        cycle takes effect at the start of the next PWM period, so changing
+//        it never makes a runt or double pulse.
+//
+//      Two modes are available:
+//
+//        PWMOUT_FAST   Single slope, twice the frequency for the resolution.
+//                      The pulse starts at the beginning of the period.
+//
+//        PWMOUT_PHASE  Dual slope, pulses are centered in the period. Better
+//                      for motor drives. On Timer1 this is the phase and
+//                      frequency correct mode, so the frequency can also be
+//                      changed without glitches.
+//
+//      Timer0 and Timer2 are 8 bits, so resolution is always 256 steps. The
+//        frequency is set by the prescaler alone, and PWMOutInit() picks the
+//        nearest one. At 16 MHz:
+//
+//          Prescale     1      8      32     64     128    256    1024
+//          Fast       62.5K  7.8K   1.9K    977    488    244     61     Hz
+//          Phase      31.4K  3.9K    980    490    245    123     31     Hz
+//
+//        (Prescales 32 and 128 are on Timer2 only.)
+//
+//      Timer1 is 16 bits, and uses ICR1 as the top count, so the frequency is
+//        set exactly and the resolution is as high as possible for that
+//        frequency: F_CPU/Freq steps in fast mode, half that in phase mode.
+//        PWMOutInit() returns the top count, so the caller can tell.
+//
+//  NOTES
+//
+//      Each timer used is taken over entirely. Timer.h uses Timer2 by default,
+//        and Capture.c, PWM.c and Freq.c (in reciprocal mode) use Timer1.
+//
+//      Pins on the 328 are OC0A=PD6, OC0B=PD5, OC1A=PB1, OC1B=PB2, OC2A=PB3
+//        and OC2B=PD3. A pin is made an output when its duty cycle is set.
+//
+//      In fast mode a compare value of zero still makes a 1 clock pulse, so 0%
+//        disconnects the pin from the timer and drives it low instead.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PWMOUT_H
+#define PWMOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Timers used depend on the next definitions.
+//
+// Defined (ie - uncommented) means the timer may be used for PWM output. Only
+//   enable timers that aren't used elsewhere.
+//
+#define PWMOUT_TIMER0
+#define PWMOUT_TIMER1
+//#define PWMOUT_TIMER2                     // Timer.h uses Timer2 by default
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#define PWMOUT_FAST     0                   // Fast (single slope) PWM
+#define PWMOUT_PHASE    1                   // Phase correct (dual slope) PWM
+
+//
+// Outputs are (Timer << 4) | Channel
+//
+#define PWMOUT_0A       0x00
+#define PWMOUT_0B       0x01
+#define PWMOUT_1A       0x10
+#define PWMOUT_1B       0x11
+#define PWMOUT_2A       0x20
+#define PWMOUT_2B       0x21
+
+#define PWMOUT_TIMER(_o_)   ((_o_) >> 4)
+
+#define PWMOUT_MAX      1000                // Duty cycle for 100%
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutInit - Setup a timer for PWM output
+//
+// Both outputs of the timer start at 0%. Calling this again changes the mode
+//   or frequency, and resets both outputs to 0%.
+//
+// Inputs:      Timer to use (0, 1 or 2)
+//              PWMOUT_FAST or PWMOUT_PHASE
+//              Frequency wanted, in Hz
+//
+// Outputs:     Top count (resolution is Top+1 steps), zero if frequency can't
+//                be done or the timer isn't enabled in PWMOut.h
+//
+uint16_t PWMOutInit(uint8_t Timer,uint8_t Mode,uint32_t Freq);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutSet - Set duty cycle of output
+//
+// Inputs:      Output to set (ie - PWMOUT_1A)
+//              Duty cycle, in % x 10 (ex: 35% -> 350)
+//
+// Outputs:     None.
+//
+void PWMOutSet(uint8_t Output,uint16_t Duty);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutSetRaw - Set compare value of output
+//
+// For full resolution: the output is high for Count/Top of the period.
+//
+// Inputs:      Output to set (ie - PWMOUT_1A)
+//              Compare value, 0 to Top
+//
+// Outputs:     None.
+//
+void PWMOutSetRaw(uint8_t Output,uint16_t Count);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutGetTop - Return top count of timer
+//
+// Inputs:      Timer to check
+//
+// Outputs:     Top count, zero if timer not setup
+//
+uint16_t PWMOutGetTop(uint8_t Timer);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMOutStop - Stop PWM output on a timer
+//
+// Both outputs are disconnected and driven low, and the timer is stopped.
+//
+// Inputs:      Timer to stop
+//
+// Outputs:     None.
+//
+void PWMOutStop(uint8_t Timer);
+
+#endif  // PWMOUT_H - entire file
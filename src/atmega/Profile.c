@@ -0,0 +1,305 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Profile.c
+//
+//  SYNOPSIS
+//
+//      See Profile.h for a complete description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <avr/interrupt.h>
+
+#include "PortMacros.h"
+#include "TimerMacros.h"
+#include "Profile.h"
+
+#ifdef USE_PROFILE
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define TCCRAx          _TCCRA(PROFILE_TIMER_ID)
+#define TCCRBx          _TCCRB(PROFILE_TIMER_ID)
+#define TCNTx           _TCNT (PROFILE_TIMER_ID)
+#define OCRBx           _OCRB (PROFILE_TIMER_ID)
+#define TIMSKx          _TIMSK(PROFILE_TIMER_ID)
+#define TIFRx           _TIFR (PROFILE_TIMER_ID)
+#define OCIEBx          _OCIEB(PROFILE_TIMER_ID)
+#define OCFBx           _OCFB (PROFILE_TIMER_ID)
+#define CS0x            _CS0  (PROFILE_TIMER_ID)
+#define CS1x            _CS1  (PROFILE_TIMER_ID)
+#define CS2x            _CS2  (PROFILE_TIMER_ID)
+#define PRTIMx          _PRTIM(PROFILE_TIMER_ID)
+#define PROBE_ISR       _TCOMPB_VECT(PROFILE_TIMER_ID)
+
+#define CS_MASK         (_PIN_MASK(CS0x) | _PIN_MASK(CS1x) | _PIN_MASK(CS2x))
+#define WGMA_MASK       (_PIN_MASK(_WGM0(PROFILE_TIMER_ID)) | _PIN_MASK(_WGM1(PROFILE_TIMER_ID)))
+#define WGMB_MASK       (_PIN_MASK(_WGM2(PROFILE_TIMER_ID)) | _PIN_MASK(_WGM3(PROFILE_TIMER_ID)))
+#define COMB_MASK       (_PIN_MASK(_COMB0(PROFILE_TIMER_ID)) | _PIN_MASK(_COMB1(PROFILE_TIMER_ID)))
+
+//
+// Probe period, a bit short of the timer wrap so that it drifts against anything
+//   else that happens once per wrap
+//
+#define PROBE_PERIOD    65521
+
+#if defined(_AVR_IOM1284P_H_) || defined(_AVR_IOM2560_H_)
+#define CPUPRR          PRR0
+#else
+#define CPUPRR          PRR
+#endif
+
+static PROFILE_STATS Profile[PROFILE_NUM_IDS] NOINIT;
+static bool          ProfileOn;             // Timer is usable, set by ProfileInit()
+
+static PROGMEM char ProfileNames[PROFILE_NUM_IDS][PROFILE_NAME_LEN] = PROFILE_NAMES;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileInit - Initialize the profiler
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the profiler is running
+//              FALSE if the timer is in use some other way (PWMOut, Freq), and nothing
+//                will be recorded
+//
+bool ProfileInit(void) {
+
+    ProfileClear();
+
+    _CLR_BIT(CPUPRR,PRTIMx);            // Power up the timer
+
+    //
+    // If the timer is already running, another module (Capture, PWM) may have set it up
+    //   free running at clk/1 and we share it. Any other mode or prescaler (PWMOut's
+    //   TOP=ICR1, Freq's external clock) would give times in the wrong units that wrap
+    //   early, so refuse those.
+    //
+    if( (TCCRBx & CS_MASK) == 0 ) {
+        TCCRAx = 0;                     // Normal counter
+        TCCRBx = _PIN_MASK(CS0x);       // clk I/O /1
+        }
+    else if( (TCCRAx & WGMA_MASK) != 0 ||
+             (TCCRBx & WGMB_MASK) != 0 ||
+             (TCCRBx & CS_MASK  ) != _PIN_MASK(CS0x) ) {
+        ProfileOn = false;
+        return false;
+        }
+
+#ifdef PROFILE_LATENCY_PROBE
+    //
+    // Leave compare B alone if the sharing module uses it (output pin or interrupt)
+    //
+    if( (TCCRAx & COMB_MASK) == 0 && !_BIT_ON(TIMSKx,OCIEBx) ) {
+        OCRBx  = TCNTx + PROBE_PERIOD;
+        TIFRx  = _PIN_MASK(OCFBx);
+        _SET_BIT(TIMSKx,OCIEBx);
+        }
+#endif
+
+    ProfileOn = true;
+    return true;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileRunning - Return TRUE if the profiler is running
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if ProfileInit() succeeded
+//
+bool ProfileRunning(void) { return ProfileOn; }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileClear - Clear the results
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ProfileClear(void) {
+    uint8_t SaveSREG = SREG;
+    cli();
+
+    memset(Profile,0,sizeof(Profile));
+
+    for( uint8_t Id=0; Id<PROFILE_NUM_IDS; Id++ ) {
+        Profile[Id].Duration.Min = 0xFFFF;
+        Profile[Id].Latency .Min = 0xFFFF;
+        }
+
+    SREG = SaveSREG;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileGetStats - Get the results for one ISR
+//
+// Inputs:      Id of ISR
+//              Ptr to returned stats
+//
+// Outputs:     None.
+//
+void ProfileGetStats(uint8_t Id,PROFILE_STATS *Stats) {
+    uint8_t SaveSREG = SREG;
+    cli();
+
+    *Stats = Profile[Id];
+
+    SREG = SaveSREG;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileGetName - Return the name of an ISR
+//
+// Inputs:      Id of ISR
+//
+// Outputs:     Ptr to name, in program memory
+//
+const char *ProfileGetName(uint8_t Id) { return ProfileNames[Id]; }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileAdd - Add one time to a histogram
+//
+// Inputs:      Ptr to histogram
+//              Time, in CPU cycles
+//
+// Outputs:     None.
+//
+static void ProfileAdd(PROFILE_HIST *Hist,uint16_t Time) {
+    uint8_t  Bin = 0;
+
+    if( Time < Hist->Min ) Hist->Min = Time;
+    if( Time > Hist->Max ) Hist->Max = Time;
+    Hist->Sum += Time;
+
+    for( uint16_t Top = PROFILE_BIN0; Time >= Top && Bin < PROFILE_BINS-1; Top <<= 1 )
+        Bin++;
+
+    Hist->Hist[Bin]++;
+
+    //
+    // Rescale before anything can overflow. Count is the sum of the bins, so it fills
+    //   up first, and Sum is at most 0xFFFF * 0xFFFF.
+    //
+    if( ++Hist->Count == 0xFFFF ) {
+        Hist->Count = 0;
+        for( Bin=0; Bin<PROFILE_BINS; Bin++ ) {
+            Hist->Hist[Bin] >>= 1;
+            Hist->Count      += Hist->Hist[Bin];
+            }
+        Hist->Sum >>= 1;
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileExit - Record one ISR call
+//
+// Called (by way of the cleanup attribute in PROFILE_ISR) when the ISR returns.
+//
+// Inputs:      Ptr to data saved at ISR start
+//
+// Outputs:     None.
+//
+void ProfileExit(PROFILE_START *Start) {
+    uint16_t       Duration = TCNTx - Start->Start;
+    PROFILE_STATS *Stats    = &Profile[Start->Id];
+
+    if( !ProfileOn )
+        return;
+
+    //
+    // Nested ISRs (ISR_NOBLOCK) can get here with interrupts on
+    //
+    uint8_t SaveSREG = SREG;
+    cli();
+
+    Stats->Count++;
+    ProfileAdd(&Stats->Duration,Duration);
+
+    if( Start->Late != PROFILE_NO_LATENCY ) {
+        Stats->LateCount++;
+        ProfileAdd(&Stats->Latency,Start->Late);
+        }
+
+    SREG = SaveSREG;
+    }
+
+
+#ifdef PROFILE_LATENCY_PROBE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TIMERx_COMPB_vect - Latency probe
+//
+// The compare time is known, so the time from the compare to here is the time this
+//   ISR was held off by other ISRs or code with interrupts off.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(PROBE_ISR) {
+    uint16_t Compare = OCRBx;
+
+    PROFILE_ISR_AT(PROFILE_PROBE,Compare);
+
+    OCRBx = Compare + PROBE_PERIOD;
+    }
+#endif  // PROFILE_LATENCY_PROBE
+
+#endif  // USE_PROFILE
@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Profile.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In Profile.h
+//      //
+//      ...Uncomment USE_PROFILE
+//      ...Choose the ISR Ids and names     (Default: UART, TWI, ADC, Servo, PWM)
+//
+//      //////////////////////////////////////
+//      //
+//      // In the ISR to be measured
+//      //
+//      ISR(TWI_vect) {
+//          PROFILE_ISR(PROFILE_TWI);               // First line of the ISR
+//              :
+//          }
+//
+//      ISR(TIMER1_CAPT_vect) {
+//          PROFILE_ISR_AT(PROFILE_PWM,ICR1);       // Latency from the captured edge
+//              :
+//          }
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c
+//      //
+//      ProfileInit();                          // Once, after the other modules' Init
+//          :
+//
+//      PROFILE_STATS Stats;
+//
+//      ProfileGetStats(PROFILE_TWI,&Stats);    // Get numbers for one ISR
+//
+//  DESCRIPTION
+//
+//      Per-ISR cycle profiler
+//
+//      Each instrumented ISR is timed from its first line to its exit (including
+//        any early return) by a free running 16-bit timer at the CPU clock, so
+//        times are in CPU cycles. For each Id the profiler keeps the number of
+//        calls, min, max and total (for the mean) duration, and a histogram.
+//
+//      Entry latency is how late the ISR starts. It can only be measured when
+//        the time of the triggering event is known on the same timer, as with
+//        input capture (ICR1) or compare (OCR1x) interrupts on the profiler's
+//        timer: use PROFILE_ISR_AT() with the event time.
+//
+//      For everything else, the latency probe measures the system latency: a
+//        compare interrupt on the profiler's timer at about 244 Hz, which sees
+//        the delays caused by other ISRs and by sections of code with
+//        interrupts off. Any vector can be held off by that much.
+//
+//      Histograms have PROFILE_BINS bins on a log scale: the first bin holds
+//        times under 32 cycles (2 uS at 16 MHz), and each bin after that
+//        doubles, with the last bin holding everything longer.
+//
+//      Each histogram counts its own samples in 16 bits. When that count fills up,
+//        every bin, the count and the sum are halved together. Older samples fade
+//        out, but the percentages and the mean stay right however long it runs,
+//        and the sum can't wrap. Min and max cover the whole run, and the call
+//        counts are exact.
+//
+//      The DE screen shows the table of results, if USE_PROFILE is defined. ScreenInit()
+//        calls ProfileInit(), so programs using the screens need not.
+//
+//  NOTES
+//
+//      With USE_PROFILE commented out, the macros generate no code.
+//
+//      Durations start after the ISR's register saves, and include any nested
+//        interrupts (ISR_NOBLOCK or sei()). The instrumentation itself adds a
+//        function call to each ISR, about 100 cycles plus the extra registers
+//        the compiler must now save.
+//
+//      The timer runs in normal mode at clk/1. Modules which run the same timer
+//        the same way (Capture.c and PWM.c on Timer1) can share it. Call
+//        ProfileInit() after their Init, so it can see how the timer is set up.
+//
+//      Profile can't be combined with PWMOut on Timer1 (TOP=ICR1 and a prescaler)
+//        or with Freq (Timer1 counts the input). If the timer is running any way
+//        other than normal mode at clk/1, ProfileInit() returns FALSE and nothing
+//        is recorded. Use Timer3 on chips that have it.
+//
+//      The latency probe is skipped if the sharing module uses compare B, either
+//        the output pin or the interrupt.
+//
+//      RAM use is 56 bytes per Id.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Profiling depends on the next definition.
+//
+// Defined (ie - uncommented) means collect ISR timing. Undefined (commented out) means
+//   the macros generate no code.
+//
+//#define USE_PROFILE
+
+#define PROFILE_TIMER_ID    1               // Free running 16-bit timer at clk/1
+
+//
+// Latency probe depends on the next definition.
+//
+// Defined (ie - uncommented) means measure the system interrupt latency, using the
+//   compare B interrupt of the profiler's timer.
+//
+#define PROFILE_LATENCY_PROBE
+
+//
+// Ids of the instrumented ISRs, and their names on the screen. Ids are indexes, so
+//   number them from zero.
+//
+#define PROFILE_UART_RX     0
+#define PROFILE_TWI         1
+#define PROFILE_ADC         2
+#define PROFILE_SERVO       3
+#define PROFILE_PWM         4
+#define PROFILE_PROBE       5               // Used by the latency probe
+
+#define PROFILE_NUM_IDS     6
+
+#define PROFILE_NAMES       { "UART RX", "TWI", "ADC", "Servo", "PWM", "Probe" }
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#define PROFILE_BINS        8               // Histogram bins
+#define PROFILE_BIN0        32              // Top of first bin, in cycles
+
+typedef struct {
+    uint16_t    Min;                        // Shortest, in CPU cycles
+    uint16_t    Max;                        // Longest
+    uint32_t    Sum;                        // Total, for the mean
+    uint16_t    Count;                      // Samples in Sum and Hist, rescaled
+    uint16_t    Hist[PROFILE_BINS];         // Counts on log scale
+    } PROFILE_HIST;
+
+typedef struct {
+    uint32_t    Count;                      // Number of calls
+    uint32_t    LateCount;                  // Number with latency measured
+    PROFILE_HIST Duration;                  // Time in the ISR
+    PROFILE_HIST Latency;                   // Time from event to ISR start
+    } PROFILE_STATS;
+
+#define PROFILE_NO_LATENCY  0xFFFF
+
+#define PROFILE_NAME_LEN    10              // Max name length, with NUL
+
+#ifdef USE_PROFILE
+
+#include "TimerMacros.h"
+
+typedef struct {
+    uint8_t     Id;                         // Which ISR
+    uint16_t    Start;                      // Timer at ISR start
+    uint16_t    Late;                       // Latency, or PROFILE_NO_LATENCY
+    } PROFILE_START;
+
+void ProfileExit(PROFILE_START *Start);
+
+#define PROFILE_NOW()       _TCNT(PROFILE_TIMER_ID)
+
+//
+// The cleanup attribute calls ProfileExit() however the ISR is left, so early
+//   returns are timed too.
+//
+#define PROFILE_ISR(_id_)                                                               \
+    PROFILE_START __attribute__ ((cleanup (ProfileExit))) _ProfileStart =               \
+        { (_id_), PROFILE_NOW(), PROFILE_NO_LATENCY }
+
+#define PROFILE_ISR_AT(_id_,_trig_)                                                     \
+    PROFILE_START __attribute__ ((cleanup (ProfileExit))) _ProfileStart =               \
+        { (_id_), PROFILE_NOW(), 0 };                                                   \
+    _ProfileStart.Late = _ProfileStart.Start - (uint16_t) (_trig_)
+
+#else
+
+#define PROFILE_ISR(_id_)
+#define PROFILE_ISR_AT(_id_,_trig_)
+
+#endif  // USE_PROFILE
+
+#ifdef USE_PROFILE
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileInit - Initialize the profiler
+//
+// Start the timer if not already running, and clear the results.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the profiler is running
+//              FALSE if the timer is in use some other way (PWMOut, Freq), and nothing
+//                will be recorded
+//
+bool ProfileInit(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileRunning - Return TRUE if the profiler is running
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if ProfileInit() succeeded
+//
+bool ProfileRunning(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileClear - Clear the results
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ProfileClear(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileGetStats - Get the results for one ISR
+//
+// Inputs:      Id of ISR
+//              Ptr to returned stats
+//
+// Outputs:     None.
+//
+void ProfileGetStats(uint8_t Id,PROFILE_STATS *Stats);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ProfileGetName - Return the name of an ISR
+//
+// Inputs:      Id of ISR
+//
+// Outputs:     Ptr to name, in program memory
+//
+const char *ProfileGetName(uint8_t Id);
+
+#else
+
+#define ProfileInit()
+#define ProfileRunning()    false
+#define ProfileClear()
+
+#endif  // USE_PROFILE
+
+#endif  // PROFILE_H - entire file
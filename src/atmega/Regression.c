@@ -54,16 +54,30 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#define Q16_MAX     INT32_MAX
+#define Q16_MIN     INT32_MIN
+
 static struct {
-    int32_t     SumX;                   // Sample point totals
-    int32_t     SumY;
-    int32_t     SumXY;
-    int32_t     SumX2;
-    int32_t     M;                      // Calculated slope
-    int32_t     B;                      // Calculated intercept
+    uint32_t    SumX;                   // Sample point totals
+    uint32_t    SumY;
+    uint64_t    SumXY;
+    uint64_t    SumX2;
+    uint64_t    SumY2;
+    int32_t     M;                      // Calculated slope,       Q16.16
+    int32_t     B;                      // Calculated intercept,   Q16.16
+    int32_t     R;                      // Calculated correlation, Q16.16
     uint16_t    N;
+#ifdef REGRESSION_WINDOW
+    uint16_t    Next;                   // Next window slot to fill
+    uint16_t    WindowX[REGRESSION_WINDOW];
+    uint16_t    WindowY[REGRESSION_WINDOW];
+#endif
     } Regression NOINIT;
 
+#ifdef REGRESSION_WINDOW
+_Static_assert(REGRESSION_WINDOW >= 2 && REGRESSION_WINDOW <= REGRESSION_MAX_N,"REGRESSION_WINDOW out of range");
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -82,69 +96,283 @@ void RegressionStart(void) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// RegressionData - Log regression data to calculation
+// RegressionAdd - Add sample to sums
+// RegressionSub - Remove sample from sums
+//
+// The sums are exact, so removing a sample undoes adding it.
 //
 // Inputs:      SampleX
-//              Sampley
+//              SampleY
 //
 // Outputs:     None.
 //
-void RegressionData(uint16_t SampleX,uint16_t SampleY) {
+static void RegressionAdd(uint16_t SampleX,uint16_t SampleY) {
 
     Regression.SumX  += SampleX;
     Regression.SumY  += SampleY;
-    Regression.SumXY += SampleX*SampleY;
-    Regression.SumX2 += SampleX*SampleX;
+    Regression.SumXY += (uint32_t) SampleX*SampleY;
+    Regression.SumX2 += (uint32_t) SampleX*SampleX;
+    Regression.SumY2 += (uint32_t) SampleY*SampleY;
     Regression.N++;
     }
 
+static void RegressionSub(uint16_t SampleX,uint16_t SampleY) {
+
+    Regression.SumX  -= SampleX;
+    Regression.SumY  -= SampleY;
+    Regression.SumXY -= (uint32_t) SampleX*SampleY;
+    Regression.SumX2 -= (uint32_t) SampleX*SampleX;
+    Regression.SumY2 -= (uint32_t) SampleY*SampleY;
+    Regression.N--;
+    }
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// RegressionCalc - Finish regression calculations
+// RegressionData - Log regression data to calculation
 //
-// Inputs:      None.
+// Inputs:      SampleX
+//              SampleY
 //
-// Outputs:     None.
+// Outputs:     TRUE  if sample was added
+//              FALSE if already REGRESSION_MAX_N samples (sample ignored)
 //
-#if 0           // Debugging
-#include "Serial.h"
-#include "SerialLong.h"
+bool RegressionData(uint16_t SampleX,uint16_t SampleY) {
+
+#ifdef REGRESSION_WINDOW
+    if( Regression.N >= REGRESSION_WINDOW )
+        RegressionSub(Regression.WindowX[Regression.Next],Regression.WindowY[Regression.Next]);
+
+    Regression.WindowX[Regression.Next] = SampleX;
+    Regression.WindowY[Regression.Next] = SampleY;
+
+    if( ++Regression.Next >= REGRESSION_WINDOW )
+        Regression.Next = 0;
+#else
+    if( Regression.N >= REGRESSION_MAX_N )
+        return false;
 #endif
 
-void RegressionCalc(void) {
-
-#if 0           // Debugging
-PrintLH(Regression.SumX);
-PrintCRLF();
-PrintLH(Regression.SumY);
-PrintCRLF();
-PrintLH(Regression.SumXY);
-PrintCRLF();
-PrintLH(Regression.SumX2);
-PrintCRLF();
-PrintLH(Regression.N);
-PrintCRLF();
+    RegressionAdd(SampleX,SampleY);
+    return true;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// RegressionRemove - Remove previously logged data from calculation
+//
+// Inputs:      SampleX
+//              SampleY
+//
+// Outputs:     None.
+//
+#ifndef REGRESSION_WINDOW
+void RegressionRemove(uint16_t SampleX,uint16_t SampleY) {
+
+    if( Regression.N == 0 )
+        return;
+
+    RegressionSub(SampleX,SampleY);
+    }
 #endif
 
-    Regression.M = (Regression.N*Regression.SumXY - Regression.SumX*Regression.SumY)/
-                   (Regression.N*Regression.SumX2 - Regression.SumX*Regression.SumX);
 
-    Regression.B = (Regression.SumY - Regression.M*Regression.SumX)/Regression.N;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Saturate - Limit 64-bit value to Q16.16 range
+//
+// Inputs:      Value to limit
+//
+// Outputs:     Value, or nearest Q16.16 limit
+//
+static int32_t Saturate(int64_t Value) {
+
+    if( Value > Q16_MAX ) return Q16_MAX;
+    if( Value < Q16_MIN ) return Q16_MIN;
+    return Value;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScaledDiv - Return (Num << Shift)/Den, without overflowing
+//
+// If Num can't be shifted all the way, Den is shifted right instead. Den keeps
+//   enough bits for the result to be good to the last Q16.16 bit, since the caller
+//   only asks for results that (nearly) fit in 32 bits.
+//
+// Inputs:      Numerator   (unsigned magnitude)
+//              Shift count
+//              Denominator (non-zero)
+//
+// Outputs:     Quotient, saturated to 64 bits
+//
+static uint64_t ScaledDiv(uint64_t Num,uint8_t Shift,uint64_t Den) {
+
+    while( Shift > 0 && Num < (1ULL << 63) ) {
+        Num <<= 1;
+        Shift--;
+        }
+
+    Den = Shift < 64 ? Den >> Shift : 0;
+
+    if( Den == 0 )
+        return UINT64_MAX;
+
+    return Num/Den;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ISqrt - Return integer square root
+//
+// Inputs:      Value
+//
+// Outputs:     Floor of square root of value
+//
+static uint32_t ISqrt(uint64_t Value) {
+    uint64_t Root = 0;
+    uint64_t Bit  = 1ULL << 62;
+
+    while( Bit > Value )
+        Bit >>= 2;
+
+    while( Bit != 0 ) {
+        if( Value >= Root + Bit ) {
+            Value -= Root + Bit;
+            Root   = (Root >> 1) + Bit;
+            }
+        else
+            Root >>= 1;
+        Bit >>= 2;
+        }
+
+    return Root;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// RegressionCalc - Finish regression calculations
+//
+// With Sxx = N*SumX2 - SumX^2, Syy = N*SumY2 - SumY^2 and Sxy = N*SumXY - SumX*SumY
+//   (each N^2 times the (co)variance),
+//
+//      M = Sxy/Sxx
+//      B = (SumY - M*SumX)/N
+//      R = Sxy/sqrt(Sxx*Syy)
+//
+// For N <= REGRESSION_MAX_N, Sxx and Syy fit in a uint64_t, and Sxy in an int64_t.
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the results are valid
+//              FALSE if fewer than 2 samples, or all X values the same
+//
+bool RegressionCalc(void) {
+    uint16_t N = Regression.N;
+
+    Regression.M = 0;
+    Regression.B = 0;
+    Regression.R = 0;
+
+    uint64_t Sxx = N*Regression.SumX2 - (uint64_t) Regression.SumX*Regression.SumX;
+    uint64_t Syy = N*Regression.SumY2 - (uint64_t) Regression.SumY*Regression.SumY;
+    int64_t  Sxy = N*Regression.SumXY - (uint64_t) Regression.SumX*Regression.SumY;
+
+    if( N < 2 || Sxx == 0 )
+        return false;
+
+    bool     Neg  = Sxy < 0;
+    uint64_t AbsXY= Neg ? -(uint64_t) Sxy : (uint64_t) Sxy;
+
+    //
+    // Slope, as an integer part and 32 bits of fraction by long division. The
+    //   intercept needs the extra bits: an error in M is multiplied by the mean
+    //   of X, up to 65535.
+    //
+    uint64_t Int  = AbsXY/Sxx;
+    uint64_t Rem  = AbsXY%Sxx;              // < Sxx < 2^62, so Rem << 1 can't overflow
+    uint32_t Frac = 0;
+
+    for( uint8_t i=0; i<32; i++ ) {
+        Rem  <<= 1;
+        Frac <<= 1;
+        if( Rem >= Sxx ) {
+            Rem  -= Sxx;
+            Frac |= 1;
+            }
+        }
+
+    int64_t B;
+
+    if( Int > (Q16_MAX >> 16) ) {
+        Regression.M = Neg ? Q16_MIN : Q16_MAX;
+        B = ((int64_t) Regression.SumY << 16) - (int64_t) Regression.M*Regression.SumX;
+        }
+    else {
+        uint32_t M = (Int << 16) | (Frac >> 16);
+
+        Regression.M = Neg ? -(int32_t) M : (int32_t) M;
+
+        //
+        // Intercept. M*SumX in Q16.16 is Int*SumX << 16 plus Frac*SumX >> 16, both
+        //   of which fit in 63 bits for Int <= 32767 and SumX < 2^31.
+        //
+        int64_t MX = (int64_t) ((Int*Regression.SumX << 16) + (((uint64_t) Frac*Regression.SumX) >> 16));
+
+        B = ((int64_t) Regression.SumY << 16) + (Neg ? MX : -MX);
+        }
+
+    Regression.B = Saturate((B + (B < 0 ? -(int64_t) N/2 : (int64_t) N/2))/N);
+
+    //
+    // Correlation. Scale Sxx and Syy up by powers of 4 first, so that their square
+    //   roots keep 31 bits of precision even for small sums.
+    //
+    if( Syy == 0 )
+        return true;
+
+    uint8_t Shift = 16;
+
+    while( Sxx < (1ULL << 62) ) { Sxx <<= 2; Shift++; }
+    while( Syy < (1ULL << 62) ) { Syy <<= 2; Shift++; }
+
+    uint64_t R = ScaledDiv(AbsXY,Shift,(uint64_t) ISqrt(Sxx)*ISqrt(Syy));
+
+    if( R > REGRESSION_ONE )                        // Rounding of the square roots
+        R = REGRESSION_ONE;
+
+    Regression.R = Neg ? -(int32_t) R : (int32_t) R;
+
+    return true;
     }
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// GetM - Return linear regression slope
-// GetB - Return linear regression intercept
+// GetSlope       - Return linear regression slope
+// GetIntercept   - Return linear regression intercept
+// GetCorrelation - Return correlation coefficient (-1.0 .. 1.0)
+// GetN           - Return number of samples in calculation
 //
 // Inputs:      None.
 //
 // Outputs:     Calculated slope
 // Outputs:     Calculated intercept
+// Outputs:     Calculated correlation coefficient
+// Outputs:     Number of samples
 //
-int32_t GetM(void) { return Regression.M; }
-int32_t GetB(void) { return Regression.B; }
+int32_t  GetSlope      (void) { return Regression.M; }
+int32_t  GetIntercept  (void) { return Regression.B; }
+int32_t  GetCorrelation(void) { return Regression.R; }
+uint16_t GetN          (void) { return Regression.N; }
@@ -22,10 +22,11 @@
 //          RegressionData(SampleX,SampleY);
 //          }
 //
-//      RegressionCalc();
-//
-//      float M = GetSlope();        // Slope
-//      float B = GetIntercept();    // Intercept
+//      if( RegressionCalc() ) {
+//          int32_t M = GetSlope();         // Slope,       Q16.16
+//          int32_t B = GetIntercept();     // Intercept,   Q16.16
+//          int32_t R = GetCorrelation();   // Correlation, Q16.16
+//          }
 //
 //  DESCRIPTION
 //
@@ -34,9 +35,31 @@
 //      Useful when calibrating a series of steps (ie - an external digital pot
 //        controlled by the micro).
 //
+//      The running sums are kept exactly in integers: 32-bit sums of X and Y,
+//        and 64-bit sums of X*X, Y*Y and X*Y. With 16-bit samples none of these
+//        can overflow for up to REGRESSION_MAX_N samples, so full scale ADC
+//        readings are fine.
+//
+//      Since the sums are exact, samples can also be taken out again with
+//        RegressionRemove() without any drift, for a sliding window. Defining
+//        REGRESSION_WINDOW does this automatically: the module keeps the last
+//        REGRESSION_WINDOW samples, and each new sample pushes out the oldest.
+//
+//      RegressionCalc() can be called at any time, as often as needed, and
+//        doesn't change the sums. Slope, intercept and the correlation
+//        coefficient are returned as Q16.16 fixed point (ie - value * 65536).
+//        The slope is rounded toward zero, and all three are within 2 LSB of
+//        the exact value (see test/host/RegressionHostTest.c). Use
+//        REGRESSION_TO_INT() and REGRESSION_FRAC() to print them.
+//
 //  NOTE
 //
-//      Uses floating point! Will be rather slow, and put a coding load on your build.
+//      No floating point: the calculation uses 64-bit integer math, which takes
+//        a few thousand cycles per divide on the AVR. RegressionData() and
+//        RegressionRemove() are only a few multiplies and adds.
+//
+//      Q16.16 holds values from -32768 to 32767.99998. Slopes and intercepts
+//        outside this range are saturated to the nearest limit.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -65,15 +88,39 @@
 #ifndef REGRESSION_H
 #define REGRESSION_H
 
-#include "Timer.h"
+#include <stdint.h>
+#include <stdbool.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// No user configurable options
+// Sliding window depends on the next definition.
+//
+// Defined (ie - uncommented) means keep the last REGRESSION_WINDOW samples, removing
+//   the oldest when a new one is added. Each sample takes 4 bytes of RAM.
+//
+// Undefined (commented out) means accumulate all samples since RegressionStart(),
+//   or use RegressionRemove() to manage a window yourself.
+//
+//#define REGRESSION_WINDOW   32
+
+//
+// End of user configurable options
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#define REGRESSION_MAX_N        32767               // Keeps N*SumXY below 2^63
+
+#define REGRESSION_ONE          (1L << 16)          // 1.0 in Q16.16
+
+//
+// For printing. Use on the absolute value, and print the sign separately.
+//
+#define REGRESSION_TO_INT(_q_)  ((_q_) >> 16)                                   // Integer part
+#define REGRESSION_FRAC(_q_)    ((uint16_t) ((((_q_) & 0xFFFF)*1000L) >> 16))   // Thousandths, 0 .. 999
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -92,12 +139,34 @@ void RegressionStart(void);
 //
 // RegressionData - Log regression data to calculation
 //
+// With REGRESSION_WINDOW defined, the oldest sample is removed once the window
+//   is full.
+//
 // Inputs:      SampleX
-//              Sampley
+//              SampleY
+//
+// Outputs:     TRUE  if sample was added
+//              FALSE if already REGRESSION_MAX_N samples (sample ignored)
+//
+bool RegressionData(uint16_t SampleX,uint16_t SampleY);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// RegressionRemove - Remove previously logged data from calculation
+//
+// The sample must be one that was previously passed to RegressionData(), and not
+//   yet removed. Not available with REGRESSION_WINDOW, which removes samples itself.
+//
+// Inputs:      SampleX
+//              SampleY
 //
 // Outputs:     None.
 //
-void RegressionData(uint16_t SampleX,uint16_t SampleY);
+#ifndef REGRESSION_WINDOW
+void RegressionRemove(uint16_t SampleX,uint16_t SampleY);
+#endif
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -107,24 +176,33 @@ void RegressionData(uint16_t SampleX,uint16_t SampleY);
 //
 // Inputs:      None.
 //
-// Outputs:     None.
+// Outputs:     TRUE  if the results are valid
+//              FALSE if fewer than 2 samples, or all X values the same
 //
-void RegressionCalc(void);
+bool RegressionCalc(void);
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// GetSlope     - Return linear regression slope
-// GetIntercept - Return linear regression intercept
+// GetSlope       - Return linear regression slope
+// GetIntercept   - Return linear regression intercept
+// GetCorrelation - Return correlation coefficient (-1.0 .. 1.0)
+// GetN           - Return number of samples in calculation
+//
+// Values are from the last RegressionCalc(), Q16.16 fixed point.
 //
 // Inputs:      None.
 //
 // Outputs:     Calculated slope
 // Outputs:     Calculated intercept
+// Outputs:     Calculated correlation coefficient, zero if all Y values the same
+// Outputs:     Number of samples
 //
-uint16_t GetSlope    (void);
-uint16_t GetIntercept(void);
+int32_t  GetSlope      (void);
+int32_t  GetIntercept  (void);
+int32_t  GetCorrelation(void);
+uint16_t GetN          (void);
 
 
 #endif  // REGRESSION_H - entire file
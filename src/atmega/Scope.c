@@ -0,0 +1,331 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//
+//  FILE
+//      Scope.c
+//
+//  DESCRIPTION
+//
+//      High speed 8-bit waveform capture
+//
+//      Stream ADCH into a RAM buffer, with pre and post trigger samples.
+//
+//      See Scope.h for an in-depth description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Scope.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define BUF_WRAP    (SCOPE_SIZE-1)
+
+typedef enum {
+    SCOPE_IDLE = 0,                                 // Not capturing
+    SCOPE_PRE,                                      // Filling pre-trigger samples
+    SCOPE_WAIT,                                     // Waiting for trigger
+    SCOPE_POST,                                     // Taking post-trigger samples
+    SCOPE_DONE,                                     // Burst complete
+    } SCOPE_STATE;
+
+static volatile struct {
+    uint8_t     Buffer[SCOPE_SIZE];                 // Samples, circular
+    uint16_t    In;                                 // Next sample goes here
+    uint16_t    Count;                              // Samples left in this state
+    uint16_t    TrigIndex;                          // Buffer index of trigger sample
+    uint16_t    Pre;                                // Samples before trigger
+    uint16_t    Post;                               // Samples from trigger on
+    uint8_t     Trigger;                            // Trigger type
+    uint8_t     Level;                              // Trigger level
+    uint8_t     Prev;                               // Previous sample
+    SCOPE_STATE State;
+    } Scope NOINIT;
+
+#if   SCOPE_PRESCALE == 8
+#define ADPS_BITS   (_PIN_MASK(ADPS1) | _PIN_MASK(ADPS0))
+#elif SCOPE_PRESCALE == 16
+#define ADPS_BITS   (_PIN_MASK(ADPS2))
+#elif SCOPE_PRESCALE == 32
+#define ADPS_BITS   (_PIN_MASK(ADPS2) | _PIN_MASK(ADPS0))
+#elif SCOPE_PRESCALE == 64
+#define ADPS_BITS   (_PIN_MASK(ADPS2) | _PIN_MASK(ADPS1))
+#elif SCOPE_PRESCALE == 128
+#define ADPS_BITS   (_PIN_MASK(ADPS2) | _PIN_MASK(ADPS1) | _PIN_MASK(ADPS0))
+#else
+#error "Scope: SCOPE_PRESCALE must be one of 8, 16, 32, 64 or 128"
+#endif
+
+#define ADMUX_VAL   (_PIN_MASK(REFS0) | _PIN_MASK(ADLAR))  // AVCC ref, 8-bit result in ADCH
+
+#define ADC_STOP    (_PIN_MASK(ADEN)  | ADPS_BITS)
+#define ADC_RUN     (_PIN_MASK(ADEN)  | _PIN_MASK(ADSC)  | _PIN_MASK(ADATE) |   \
+                     _PIN_MASK(ADIE)  | _PIN_MASK(ADIF)  | ADPS_BITS)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeInit - Initialize waveform capture
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ScopeInit(void) {
+
+    memset((void *) &Scope,0,sizeof(Scope));
+
+    _CLR_BIT(PRR,PRADC);                    // Powerup the A/D converter
+
+    DIDR0  = 0;                             // Turn off digital outputs
+    ADCSRB = 0;                             // Free running when ADATE is set
+    ADMUX  = ADMUX_VAL;
+    ADCSRA = ADC_STOP;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeArm - Start a capture
+//
+// Inputs:      AtoD channel to capture
+//              Trigger (SCOPE_NOW, SCOPE_RISING or SCOPE_FALLING)
+//              Trigger level (0 .. 255)
+//              Number of samples to keep before the trigger
+//              Number of samples to keep from the trigger on (at least 1)
+//
+// Outputs:     None.
+//
+void ScopeArm(uint8_t Channel,uint8_t Trigger,uint8_t Level,uint16_t Pre,uint16_t Post) {
+
+    ScopeStop();
+
+    if( Pre  > SCOPE_SIZE-1 )   Pre  = SCOPE_SIZE-1;
+    if( Post > SCOPE_SIZE-Pre ) Post = SCOPE_SIZE-Pre;
+    if( Post == 0 )             Post = 1;
+
+    Scope.In      = 0;
+    Scope.Pre     = Pre;
+    Scope.Post    = Post;
+    Scope.Count   = Pre;
+    Scope.Trigger = Trigger;
+    Scope.Level   = Level;
+
+    //
+    // Start Prev on the far side of the level, so that with no pre-trigger
+    //   samples the first sample can't trigger
+    //
+    Scope.Prev    = Trigger == SCOPE_RISING ? 0xFF : 0x00;
+    Scope.State   = Pre ? SCOPE_PRE : SCOPE_WAIT;
+
+    ADMUX  = ADMUX_VAL | Channel;
+    ADCSRA = ADC_RUN;                       // First conversion starts free running
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeStop - Stop a capture
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ScopeStop(void) {
+
+    ADCSRA = ADC_STOP;
+    if( Scope.State != SCOPE_DONE )
+        Scope.State = SCOPE_IDLE;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeDone - Return TRUE if capture has finished
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the burst is complete and can be read
+//              FALSE if still waiting for the trigger or post-trigger samples
+//
+bool ScopeDone(void) { return Scope.State == SCOPE_DONE; }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeRead - Copy out the captured burst
+//
+// Inputs:      Ptr to array of samples to fill
+//              Max number of samples to return
+//
+// Outputs:     Number of samples returned, zero if capture not done
+//
+uint16_t ScopeRead(uint8_t *Samples,uint16_t Max) {
+    uint16_t Index;
+    uint16_t nSamples;
+
+    if( !ScopeDone() )
+        return 0;
+
+    Index = (Scope.TrigIndex - Scope.Pre) & BUF_WRAP;
+
+    for( nSamples = 0; nSamples < Scope.Pre+Scope.Post && nSamples < Max; nSamples++ ) {
+        *Samples++ = Scope.Buffer[Index];
+        Index = (Index+1) & BUF_WRAP;
+        }
+
+    return nSamples;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeDump - Send the captured burst out the serial port
+//
+// Inputs:      SCOPE_HEX or SCOPE_BINARY
+//
+// Outputs:     None.
+//
+void ScopeDump(uint8_t Format) {
+    uint16_t Index;
+    uint16_t nSamples;
+
+    if( !ScopeDone() )
+        return;
+
+    Index    = (Scope.TrigIndex - Scope.Pre) & BUF_WRAP;
+    nSamples = Scope.Pre+Scope.Post;
+
+    if( Format == SCOPE_BINARY ) {
+        PutUARTByteW(0xA5);
+        PutUARTByteW(0x5A);
+        PutUARTByteW(nSamples  & 0xFF);
+        PutUARTByteW(nSamples  >> 8);
+        PutUARTByteW(Scope.Pre & 0xFF);
+        PutUARTByteW(Scope.Pre >> 8);
+
+        while( nSamples-- ) {
+            PutUARTByteW(Scope.Buffer[Index]);
+            Index = (Index+1) & BUF_WRAP;
+            }
+        return;
+        }
+
+    PrintString("SCOPE ");
+    PrintD(nSamples,0);
+    PrintChar(' ');
+    PrintD(Scope.Pre,0);
+    PrintChar(' ');
+    PrintLD(SCOPE_HZ,0);
+    PrintCRLF();
+
+    for( uint16_t i = 0; i < nSamples; i++ ) {
+        PrintH(Scope.Buffer[Index]);
+        Index = (Index+1) & BUF_WRAP;
+        if( (i & 0x0F) == 0x0F || i == nSamples-1 ) PrintCRLF();
+        else                                         PrintChar(' ');
+        }
+
+    PrintString("END\r\n");
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ADC_vect - A/D interrupt processing
+//
+// Kept short, since at /8 there are only 104 cycles per sample.
+//
+// Inputs:      None. (ISR)
+//
+// Outputs:     None.
+//
+ISR(ADC_vect) {
+    uint8_t  Sample = ADCH;
+    uint16_t In     = Scope.In;
+    uint8_t  Prev;
+
+    Scope.Buffer[In] = Sample;
+    Scope.In = (In+1) & BUF_WRAP;
+
+    switch( Scope.State ) {
+
+        case SCOPE_PRE:
+            Scope.Prev = Sample;
+            if( --Scope.Count == 0 )
+                Scope.State = SCOPE_WAIT;
+            break;
+
+        case SCOPE_WAIT:
+            Prev       = Scope.Prev;
+            Scope.Prev = Sample;
+
+            if( Scope.Trigger == SCOPE_RISING  && !(Prev <  Scope.Level && Sample >= Scope.Level) )
+                break;
+            if( Scope.Trigger == SCOPE_FALLING && !(Prev >  Scope.Level && Sample <= Scope.Level) )
+                break;
+
+            Scope.TrigIndex = In;
+            Scope.Count     = Scope.Post;
+            Scope.State     = SCOPE_POST;
+            //
+            // Fall through - the trigger sample is the first post sample
+            //
+
+        case SCOPE_POST:
+            if( --Scope.Count == 0 ) {
+                ADCSRA      = ADC_STOP;
+                Scope.State = SCOPE_DONE;
+                }
+            break;
+
+        default:                            // Spurious, or a late one after stop
+            break;
+        }
+    }
@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//
+//  FILE
+//      Scope.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In Scope.h
+//      //
+//      ...Choose ADC prescale             (Default: 16, ~77 KHz sample rate)
+//      ...Choose buffer size              (Default: 512 samples)
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c
+//      //
+//      ScopeInit();                        // Called once at startup
+//          :
+//
+//      ScopeArm(0,SCOPE_RISING,128,100,400);   // Chan 0, 100 samples before, 400 after
+//
+//      while( !ScopeDone() )
+//          ...Do other things
+//
+//      ScopeDump(SCOPE_HEX);               // Send the burst out the serial port
+//
+//  DESCRIPTION
+//
+//      High speed 8-bit waveform capture
+//
+//      The ADC runs free with the result left adjusted (ADLAR), and the ISR
+//        stores ADCH into a circular RAM buffer. Dropping the 2 low bits allows
+//        a faster ADC clock: at /16 the ADC clock is 1 MHz, for 76,923 samples
+//        per second at about 8 bits of accuracy.
+//
+//      Capture is armed with a trigger, a trigger level, and the number of
+//        samples wanted before (pre-trigger) and after (post-trigger) the
+//        trigger point. The buffer keeps filling until at least Pre samples
+//        have been taken, then the trigger is checked on each sample. After
+//        the trigger, Post more samples are taken (counting the trigger
+//        sample) and the ADC is stopped.
+//
+//      SCOPE_RISING triggers on the first sample at or above Level after one
+//        below it, SCOPE_FALLING on the first sample at or below Level after
+//        one above it. SCOPE_NOW triggers at once, for a free-running capture.
+//
+//      The burst can be copied out with ScopeRead(), or sent out the serial
+//        port with ScopeDump():
+//
+//        SCOPE_HEX:    Text header, then 16 hex bytes per line
+//
+//                        SCOPE <Samples> <Pre> <Samples/sec>
+//                        7F 80 82 ...
+//                        END
+//
+//        SCOPE_BINARY: 0xA5 0x5A, then 16-bit LSB first sample count and pre
+//                        count, then the raw samples. At 115200 baud a 512
+//                        sample burst takes about 45 mS to send.
+//
+//  NOTES
+//
+//      Uses the ADC exclusively: this module can't be used together with
+//        AtoD.c, ACS712.c or AtoDShare.c.
+//
+//      At /16 the ISR has 208 CPU cycles per sample, which is plenty. At /8
+//        (153,846 samples/sec, 104 cycles) the ISR takes most of the CPU
+//        while capturing, and other interrupts that run long will cause
+//        missed samples. The sample accuracy is also worse at /8.
+//
+//      Other interrupts still run during capture. They don't add jitter, since
+//        the ADC clock times each conversion rather than the ISR, but one that
+//        runs longer than a sample time will cause a sample to be lost.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ADC clock prescale, one of 8, 16, 32, 64 or 128. Each sample takes 13 ADC
+//   clocks, so the sample rate is F_CPU/(SCOPE_PRESCALE*13).
+//
+#define SCOPE_PRESCALE  16
+
+//
+// The buffer must be a power of two long, since the code uses masking to wrap
+//   the index. Each sample takes 1 byte.
+//
+#ifndef SCOPE_SIZE
+#define SCOPE_SIZE      (1 << 9)                    // == 512 samples
+#endif
+
+//
+// End of user configurable options
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+#define SCOPE_NOW       0                           // Trigger immediately
+#define SCOPE_RISING    1                           // Trigger on rising  crossing
+#define SCOPE_FALLING   2                           // Trigger on falling crossing
+
+#define SCOPE_HEX       0                           // ScopeDump formats
+#define SCOPE_BINARY    1
+
+#define SCOPE_HZ        (F_CPU/(SCOPE_PRESCALE*13UL))   // Samples per second
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeInit - Initialize waveform capture
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ScopeInit(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeArm - Start a capture
+//
+// Any capture in progress is abandoned. Pre+Post is limited to SCOPE_SIZE.
+//
+// Inputs:      AtoD channel to capture
+//              Trigger (SCOPE_NOW, SCOPE_RISING or SCOPE_FALLING)
+//              Trigger level (0 .. 255)
+//              Number of samples to keep before the trigger
+//              Number of samples to keep from the trigger on (at least 1)
+//
+// Outputs:     None.
+//
+void ScopeArm(uint8_t Channel,uint8_t Trigger,uint8_t Level,uint16_t Pre,uint16_t Post);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeStop - Stop a capture
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void ScopeStop(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeDone - Return TRUE if capture has finished
+//
+// Inputs:      None.
+//
+// Outputs:     TRUE  if the burst is complete and can be read
+//              FALSE if still waiting for the trigger or post-trigger samples
+//
+bool ScopeDone(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeRead - Copy out the captured burst
+//
+// Samples are returned oldest first, with the trigger sample at index Pre.
+//
+// Inputs:      Ptr to array of samples to fill
+//              Max number of samples to return
+//
+// Outputs:     Number of samples returned, zero if capture not done
+//
+uint16_t ScopeRead(uint8_t *Samples,uint16_t Max);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeDump - Send the captured burst out the serial port
+//
+// Does nothing if the capture isn't done. Blocks until sent.
+//
+// Inputs:      SCOPE_HEX or SCOPE_BINARY, see above
+//
+// Outputs:     None.
+//
+void ScopeDump(uint8_t Format);
+
+#endif  // SCOPE_H - entire file
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Stack.c
+//
+//  SYNOPSIS
+//
+//      See Stack.h for a complete description
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "PortMacros.h"
+#include "Stack.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//
+// Section boundaries, from the linker script
+//
+extern uint8_t __data_start;
+extern uint8_t __data_end;
+extern uint8_t __bss_start;
+extern uint8_t __bss_end;
+extern uint8_t __noinit_start;
+extern uint8_t __noinit_end;
+extern uint8_t _end;                        // End of all statics
+extern uint8_t __stack;                     // Top of stack (RAMEND)
+
+static volatile struct {
+    uint8_t    *Scan;                       // Next byte to check
+    uint8_t    *Mark;                       // Lowest byte known to be used
+    } Stack NOINIT;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StackPaint - Paint free RAM at reset
+//
+// Runs in .init1, before the stack pointer and r1 are set up, so it's in assembler
+//   and uses no stack. Paints from the end of the statics up to, but not including,
+//   the top of the stack.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void StackPaint(void) __attribute__ ((naked,used,section (".init1")));
+
+void StackPaint(void) {
+
+    __asm__ __volatile__ (
+        "       ldi     r30,lo8(_end)       \n"
+        "       ldi     r31,hi8(_end)       \n"
+        "       ldi     r24,%0              \n"
+        "       ldi     r25,hi8(__stack)    \n"
+        "1:     cpi     r30,lo8(__stack)    \n"
+        "       cpc     r31,r25             \n"
+        "       brsh    2f                  \n"
+        "       st      Z+,r24              \n"
+        "       rjmp    1b                  \n"
+        "2:                                 \n"
+        : : "M" (STACK_CANARY) : "r24","r25","r30","r31","memory");
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StackInit - Initialize stack monitor
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void StackInit(void) {
+
+    Stack.Scan = &_end;
+    Stack.Mark = (uint8_t *) (uintptr_t) SP + 1;    // SP points to the next free byte
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StackUpdate - Scan the next few bytes of stack
+//
+// The first byte that isn't paint is the new mark. Reaching the old mark means
+//   the stack hasn't grown, so start the next pass from the bottom.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void StackUpdate(void) {
+    uint8_t *Scan = Stack.Scan;
+    uint8_t *Mark = Stack.Mark;
+
+    for( uint8_t i=0; i<STACK_SCAN_BYTES; i++ ) {
+
+        if( Scan >= Mark ) {
+            Scan = &_end;
+            break;
+            }
+
+        if( *Scan != STACK_CANARY ) {
+            Stack.Mark = Scan;
+            Scan       = &_end;
+            break;
+            }
+
+        Scan++;
+        }
+
+    Stack.Scan = Scan;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StackGetStats - Return RAM usage
+//
+// Inputs:      Ptr to returned stats
+//
+// Outputs:     None.
+//
+void StackGetStats(STACK_STATS *Stats) {
+    uint8_t SaveSREG = SREG;
+    cli();
+    uint8_t *Mark = Stack.Mark;
+    SREG = SaveSREG;
+
+    Stats->Data   = &__data_end   - &__data_start;
+    Stats->BSS    = &__bss_end    - &__bss_start;
+    Stats->NoInit = &__noinit_end - &__noinit_start;
+    Stats->Stack  = &__stack      - Mark + 1;
+    Stats->Free   = Mark > &_end ? Mark - &_end : 0;
+    }
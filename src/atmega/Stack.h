@@ -1,73 +1,65 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//      Copyright (C) 2010 Peter Walsh, Milford, NH 03055
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
 //      All Rights Reserved under the MIT license as outlined below.
 //
 //  FILE
-//      TimerB.h
+//      Stack.h
 //
 //  SYNOPSIS
 //
 //      //////////////////////////////////////
 //      //
-//      // In TimerB.h
+//      // In Main.c
 //      //
-//      ...Choose a timer                  (Default: Timer1)
-//      ...Choose Polled or interrupt mode (Default: Interrupt)
-//      ...Choose tick duration            (Default: 25ms)
-//
-//      //////////////////////////////////////
-//      //
-//      // Polled mode
-//      //
-//      TimerBInit();                       // Called once at startup
+//      StackInit();                        // Called once at startup
 //          :
 //
-//      while(1) {
-//          while( !TimerBChanged )
-//              sleep_cpu();                // Wait for tick to happen
-//
-//          TimerBChanged = false;          // Reset flag
-//              :           :               // Do local updates
+//      void TimerISR(void) {               // Or in the main loop
+//          StackUpdate();                  // Scan a few bytes
+//              :
 //          }
 //
-//      //////////////////////////////////////
-//      //
-//      // Interrupt mode
-//      //
-//      void TimerBISR(void) {              // Called once every tick
-//          ...do all update functions
-//          }
+//      STACK_STATS Stats;
 //
+//      StackGetStats(&Stats);              // Get RAM usage
 //
-//      TimerBInit();                       // Called once at startup
-//          :
+//  DESCRIPTION
 //
-//      while(1) {
-//          sleep_cpu();
-//          }
+//      Stack high-water and RAM usage monitor
 //
-//      //////////////////////////////////////
-//      //
-//      // General - time since reset
-//      //
-//      TIME_T CurrentSecs = TimerBGetSeconds();    // == Realtime seconds
-//      TIME_T CurrentMS   = TimerBGetMS();         // == MS since second
+//      At reset, before anything else runs (in .init1), all RAM between the
+//        end of the statics (.data, .bss and .noinit) and the top of the stack
+//        is painted with STACK_CANARY.
 //
-//  DESCRIPTION
+//      StackUpdate() then scans a few bytes per call upward from the end of
+//        the statics, looking for the lowest byte that is no longer paint.
+//        That is the deepest the stack has ever been. Each pass restarts from
+//        the bottom, so a deeper stack is found on the next pass.
+//
+//      StackGetStats() returns the sizes of .data, .bss and .noinit, the
+//        stack high-water, and the free RAM left below it. Free RAM of zero
+//        means the stack has grown into the statics, and NOINIT data (or
+//        anything else) may have been overwritten.
 //
-//      TimerB processing
+//      The ME screen shows these numbers. Programs that use the screens don't
+//        need to call StackInit() or StackUpdate(), as ScreenInit() and
+//        ScreenUpdate() do that when the ME screen is enabled.
 //
-//      This is a copy of the "Timer.h" file, but referring to TimerB in all cases.
+//  NOTES
 //
-//      This allows programs to have more than one timer running at different speeds.
+//      The cost is STACK_SCAN_BYTES compares per call. Called once a tick, a
+//        full pass over 1K of free RAM takes a few seconds.
 //
-//      See Timer.h for a complete description
+//      The high-water is only as good as the deepest stack seen so far, so
+//        exercise the code paths of interest (and the ISRs) before trusting it.
 //
-//  EXAMPLE
+//      The heap (malloc) also grows up from the end of the statics, and will
+//        be counted as stack.
 //
-//      See Timer.h
+//      Painting only happens at power up or reset, so NOINIT data are never
+//        touched by it.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -93,84 +85,74 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#ifndef TIMERB_H
-#define TIMERB_H
+#ifndef STACK_H
+#define STACK_H
 
-#include "Timer.h"
+#include <stdint.h>
+#include <stdbool.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// Specify a TimerB to use.
+// Paint value. Any value works, but one that's unlikely as data (not 0x00 or 0xFF)
+//   gives a slightly better high-water.
 //
-// See Timer.h for explanation and list of examples.
+#define STACK_CANARY        0xC5
+
 //
+// Bytes to check on each call to StackUpdate()
 //
-#define TIMERB_ID      1                         // use TIMER1
-#define MS_PER_TICKB   25
-#define CLOCK_BITSB    (1 << WGM12) | (1 << CS12) | (1 << CS10)
-#define CTC_MODEB      0
-#define CLOCK_COUNTB   391
+#define STACK_SCAN_BYTES    16
 
 //
-// Polled mode/ISR mode depends on the next definition.
+// End of user configurable options
 //
-// Defined (ie - uncommented) means call TimerBISR. Undefined (commented out)
-//   means don't.
-// 
-// If you only need the TimerBGetSeconds() or TimerBGetTicks() functions, select
-//   polled mode & comment this out.
-//
-#define CALL_TimerBISR
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Data definitions and macros
 //
-#define SECONDSB(_t_)       ((TIME_T) (((_t_)*1000+MS_PER_TICKB/2)/MS_PER_TICKB) )
-#define MINUTESB(_t_)       ((TIME_T) (60*SECONDSB(_t_)) )
-#define HOURSB(_t_)         ((TIME_T) (60*MINUTESB(_t_)) )
+typedef struct {
+    uint16_t    Data;                       // Size of .data   (initialized statics)
+    uint16_t    BSS;                        // Size of .bss    (zeroed statics)
+    uint16_t    NoInit;                     // Size of .noinit (NOINIT statics)
+    uint16_t    Stack;                      // Stack high-water, bytes
+    uint16_t    Free;                       // Free RAM below the high-water
+    } STACK_STATS;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBInit - Initialize timer system
+// StackInit - Initialize stack monitor
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
-void TimerBInit(void);
+void StackInit(void);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBGetSeconds - Return seconds since TimerBInit()
-// TimerBGetMS      - Get milliseconds since previous second
+// StackUpdate - Scan the next few bytes of stack
+//
+// Call from only one place, either the main loop or an ISR such as TimerISR().
 //
 // Inputs:      None.
 //
-// Outputs:     The value specified.
+// Outputs:     None.
 //
-TIME_T TimerBGetSeconds(void);
-TIME_T TimerBGetMS     (void);
+void StackUpdate(void);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBISR - User's timer update routine
+// StackGetStats - Return RAM usage
 //
-// Inputs:      None.
+// Inputs:      Ptr to returned stats
 //
 // Outputs:     None.
 //
-// NOTE: Only defined if CALL_TimerBISR is #defined, see above.
-//
-#ifdef CALL_TimerBISR
-void TimerBISR(void);
-#else
-extern volatile bool    TimerBChanged;      // Set TRUE at each tick
-#endif
+void StackGetStats(STACK_STATS *Stats);
 
-#endif  // TIMERB_H - entire file
+#endif  // STACK_H - entire file
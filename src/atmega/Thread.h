@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      Thread.h
+//
+//  SYNOPSIS
+//
+//      static THREAD_T Blink;                  // Thread state
+//
+//      THREAD_STATUS BlinkThread(THREAD_T *Thread) {
+//          static uint8_t Count;               // NOTE: Locals must be static
+//
+//          THREAD_BEGIN(Thread);
+//
+//          for( Count=0; Count<10; Count++ ) {
+//              _SET_BIT(LED_PORT,LED_BIT);
+//              THREAD_WAIT_MS(Thread,500);     // Other code runs while waiting
+//              _CLR_BIT(LED_PORT,LED_BIT);
+//              THREAD_WAIT_MS(Thread,500);
+//              }
+//
+//          GetI2C(SlaveAddr,1,Buffer);
+//          THREAD_WAIT_I2C(Thread);            // Wait for I2C completion
+//
+//          THREAD_END(Thread);
+//          }
+//
+//      THREAD_INIT(&Blink);                    // Start the thread
+//
+//      while(1) {
+//          sleep_cpu();
+//          TimerUpdate();
+//
+//          if( THREAD_RUNNING(&Blink) )        // Run until next wait
+//              BlinkThread(&Blink);
+//
+//          while( (InChar = GetUARTByte()) )   // Command line stays live
+//              ProcessInput(InChar);
+//          }
+//
+//  DESCRIPTION
+//
+//      Stackless threads (aka "protothreads")
+//
+//      Long running operations - such as sending a train of pulses, or scanning
+//        the I2C bus - are often written as loops with _delay_ms() or spins on
+//        I2CBusy(). While these run, nothing else in the main loop gets done
+//        and the command line is dead.
+//
+//      These macros let such an operation be written as straight-line code which
+//        gives up the CPU whenever it has to wait. Each call to the thread
+//        function runs until the next wait, then returns. The next call picks
+//        up where the previous one left off.
+//
+//      No stack is kept between calls: the only state is the THREAD_T, which
+//        holds the resume point and a wait timer (6 bytes).
+//
+//      The timed waits use TimerGetTime(), so the resolution is one timer tick
+//        (MS_PER_TICK), or better with the tickless timer. See Timer.h
+//
+//  NOTES
+//
+//      The resume point is implemented with a switch statement (Duff's device),
+//        so local variables are NOT preserved across waits. Use static variables
+//        or keep the state in a struct.
+//
+//      For the same reason, a thread function cannot contain a switch statement
+//        that spans a wait, and two waits can't appear on the same source line.
+//
+//      A thread may post events or be run from an event handler. See Event.h
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "Timer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+typedef struct {
+    uint16_t    Line;                           // Resume point, 0 == not running
+    TIME_T      Start;                          // Start of timed wait
+    } THREAD_T;
+
+typedef enum {
+    THREAD_WAITING,                             // Thread is waiting, call again later
+    THREAD_DONE,                                // Thread has finished
+    } THREAD_STATUS;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// THREAD_INIT    - Setup thread to start from the beginning
+// THREAD_STOP    - Stop thread from outside (ie - from a command)
+// THREAD_RUNNING - Return TRUE if thread has been started and not finished
+//
+// Inputs:      Ptr to thread state
+//
+#define THREAD_INIT(_t_)        { (_t_)->Line = 1; }
+#define THREAD_STOP(_t_)        { (_t_)->Line = 0; }
+#define THREAD_RUNNING(_t_)     ((_t_)->Line != 0)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// THREAD_BEGIN - Start of thread code
+// THREAD_END   - End   of thread code
+// THREAD_EXIT  - Finish thread early
+//
+// Inputs:      Ptr to thread state
+//
+#define THREAD_BEGIN(_t_)       switch((_t_)->Line) { case 1:
+
+#define THREAD_END(_t_)         default: ; } (_t_)->Line = 0; return THREAD_DONE;
+
+#define THREAD_EXIT(_t_)        { (_t_)->Line = 0; return THREAD_DONE; }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// THREAD_YIELD      - Give up the CPU once, continue at next call
+// THREAD_WAIT_UNTIL - Give up the CPU until condition is TRUE
+// THREAD_WAIT_MS    - Give up the CPU for a number of MS
+// THREAD_WAIT_I2C   - Give up the CPU until current I2C transfer completes
+//
+// Inputs:      Ptr to thread state
+//              Condition to wait for, or MS to wait
+//
+#define THREAD_YIELD(_t_)                                                               \
+    { (_t_)->Line = __LINE__; return THREAD_WAITING; case __LINE__: ; }
+
+#define THREAD_WAIT_UNTIL(_t_,_cond_)                                                   \
+    { (_t_)->Line = __LINE__; case __LINE__: if( !(_cond_) ) return THREAD_WAITING; }
+
+#define THREAD_WAIT_MS(_t_,_ms_)                                                        \
+    { (_t_)->Start = TimerGetTime();                                                    \
+      THREAD_WAIT_UNTIL(_t_,TimerGetTime() - (_t_)->Start >= (TIME_T) (_ms_));          \
+      }
+
+#define THREAD_WAIT_I2C(_t_)    THREAD_WAIT_UNTIL(_t_,!I2CBusy())
+
+#endif  // THREAD_H - entire file
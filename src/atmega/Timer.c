@@ -47,6 +47,10 @@
 #include "Timer.h"
 #include "TimerMacros.h"
 
+#ifdef POST_TimerEvent
+#include "Event.h"
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -55,11 +59,17 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static struct {
+static volatile struct {
     TIME_T      Seconds;                            // Seconds since init
     uint16_t    MS;                                 // MS within second
     uint16_t    Countdown;                          // Interrupt count
     bool        Changed;                            // Set TRUE at each tick
+    uint32_t    Wakeups;                            // Timer interrupts since init
+    uint8_t     Sequence;                           // Changes at each interrupt
+#ifdef TICKLESS_TIMER
+    uint32_t    Counts;                             // Timer counts within second, at start of period
+    uint32_t    Remaining;                          // Counts from start of period to deadline
+#endif
     } Timer NOINIT;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -76,9 +86,76 @@ static struct {
 #define OCRAx       _OCRA(TIMER_ID)
 #define OCIEAx      _OCIEA(TIMER_ID)
 
+#define TIFRx       _TIFR(TIMER_ID)
+#define OCFAx       _OCFA(TIMER_ID)
+
 #define DISABLE_INT _CLR_BIT(TIMSKx,OCIEAx)
 #define ENABLE_INT  _SET_BIT(TIMSKx,OCIEAx)
 
+//
+// CTC mode with OCRA as top is WGMx1 in TCCRA on 8-bit timers, and WGMx2 in TCCRB
+//   on 16-bit timers.
+//
+#if TIMER_MAX > 255
+#define CTC_MODEA   0
+#define CTC_MODEB   _PIN_MASK(_WGM2(TIMER_ID))
+#else
+#define CTC_MODEA   _PIN_MASK(_WGM1(TIMER_ID))
+#define CTC_MODEB   0
+#endif
+
+#define CLOCK_BITS  (CLOCK_SELECT << _CS0(TIMER_ID))
+
+//
+// Lock-free read of data shared with the ISR: repeat the read until no timer
+//   interrupt happened during it.
+//
+#define TIMER_READ(_stmt_)  do {                                                \
+                                uint8_t _seq_;                                  \
+                                do {                                            \
+                                    _seq_ = Timer.Sequence;                     \
+                                    _stmt_;                                     \
+                                    } while( _seq_ != Timer.Sequence );         \
+                                } while(0)
+
+#ifdef TICKLESS_TIMER
+#define MAX_PERIOD  ((uint32_t) TIMER_MAX + 1)      // Longest period the timer can count
+#define MIN_AHEAD   2                               // Min counts between TCNT and new OCRA
+
+//
+// Timer counts within a second to MS. Counts*1000 overflows 32 bits when the
+//   timer runs faster than about 4 MHz (ie - /1 or /8 prescale).
+//
+#if TIMER_HZ % 1000 == 0
+#define COUNTS_TO_MS(_c_)   ((_c_)/(TIMER_HZ/1000))
+#elif TIMER_HZ < 4294967UL
+#define COUNTS_TO_MS(_c_)   (((_c_)*1000)/TIMER_HZ)
+#else
+#define COUNTS_TO_MS(_c_)   (((uint64_t) (_c_)*1000)/TIMER_HZ)
+#endif
+
+static uint32_t TimerNow(TIME_T *Seconds);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerNextPeriod - Return length of next timer period
+//
+// Waits longer than the timer can count are split into full periods. The last
+//   two are split evenly, so that a period is never so short that TCNT could
+//   pass OCRA before the ISR gets to write it.
+//
+static inline uint32_t TimerNextPeriod(void) {
+
+    if( Timer.Remaining == 0 || Timer.Remaining >= 2*MAX_PERIOD )
+        return MAX_PERIOD;
+
+    if( Timer.Remaining > MAX_PERIOD )
+        return Timer.Remaining/2;
+
+    return Timer.Remaining;
+    }
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -90,7 +167,7 @@ static struct {
 //
 void TimerInit(void) {
 
-    memset(&Timer,0,sizeof(Timer));
+    memset((void *) &Timer,0,sizeof(Timer));
 
 #if defined(_AVR_IOM1284P_H_) || defined(_AVR_IOM2560_H_)
     _CLR_BIT(PRR0,PRTIMx);          // Powerup the clock
@@ -101,10 +178,15 @@ void TimerInit(void) {
     //
     // Setup the timer as free running, with OCRA as top value
     //
-    TCCRAx = 0;                     // No output compare functions
-    TCCRBx = CLOCK_BITS | CTC_MODE; // Set appropriate clock
+    TCCRAx = CTC_MODEA;             // No output compare functions
+    TCCRBx = CLOCK_BITS | CTC_MODEB;// Set appropriate clock
     TCNTx  = 0;
+
+#ifdef TICKLESS_TIMER
+    OCRAx  = TIMER_MAX;             // No deadline - count full periods
+#else
     OCRAx  = CLOCK_COUNT-1;         // And clock count for ticks
+#endif
 
     Timer.Countdown = TIMER_COUNT;
 
@@ -130,21 +212,14 @@ bool TimerUpdate(void) {
         return(false);
 
     //
-    // Otherwise, update the timer and inform the caller
+    // Otherwise, inform the caller
     //
-    Timer.MS += MS_PER_TICK;
-
-    if( Timer.MS >= 1000 ) {
-        Timer.MS -= 1000;
-        Timer.Seconds++;
-        }
-
     Timer.Changed = false;
 
     //
     // Call the user's function
     //
-#ifdef CALL_TimerISR
+#if defined(CALL_TimerISR) && !defined(TIMER_ISR_CONTEXT)
     TimerISR();
 #endif
 
@@ -154,7 +229,7 @@ bool TimerUpdate(void) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerGetSeconds - Return seconds since TimerBInit()
+// TimerGetSeconds - Return seconds since TimerInit()
 // TimerGetMS      - Get milliseconds since previous second
 //
 // Inputs:      None.
@@ -164,9 +239,11 @@ bool TimerUpdate(void) {
 TIME_T TimerGetSeconds(void) {
     TIME_T Rtnval;
 
-    DISABLE_INT;                    // Disable interrupts
-    Rtnval = Timer.Seconds;
-    ENABLE_INT;                     // Allow interrupts
+#ifdef TICKLESS_TIMER
+    TimerNow(&Rtnval);
+#else
+    TIMER_READ(Rtnval = Timer.Seconds);
+#endif
 
     return Rtnval;
     }
@@ -174,13 +251,180 @@ TIME_T TimerGetSeconds(void) {
 uint16_t TimerGetMS(void) {
     TIME_T Rtnval;
 
-    DISABLE_INT;                    // Disable interrupts
-    Rtnval = Timer.MS;
-    ENABLE_INT;                     // Allow interrupts
+#ifdef TICKLESS_TIMER
+    TIME_T Seconds;
+
+    Rtnval = COUNTS_TO_MS(TimerNow(&Seconds));
+#else
+    TIMER_READ(Rtnval = Timer.MS);
+#endif
+
+    return Rtnval;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerGetTime - Return MS since TimerInit()
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+TIME_T TimerGetTime(void) {
+    TIME_T Rtnval;
+
+#ifdef TICKLESS_TIMER
+    uint32_t Counts = TimerNow(&Rtnval);
+
+    Rtnval = Rtnval*1000 + COUNTS_TO_MS(Counts);
+#else
+    TIMER_READ(Rtnval = Timer.Seconds*1000 + Timer.MS);
+#endif
 
     return Rtnval;
     }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerGetWakeups - Return number of timer interrupts since TimerInit()
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint32_t TimerGetWakeups(void) {
+    uint32_t Rtnval;
+
+    TIMER_READ(Rtnval = Timer.Wakeups);
+
+    return Rtnval;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerGetCounts - Return timer counts since TimerInit()
+//
+// In tick mode every period is CLOCK_COUNT long, so the count is the number of
+//   periods plus the live TCNT value. As with TimerNow(), a period that has ended
+//   but whose ISR hasn't run yet is added in here.
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint32_t TimerGetCounts(void) {
+    uint32_t Counts;
+
+#ifdef TICKLESS_TIMER
+    TIME_T Seconds;
+
+    Counts  = TimerNow(&Seconds);
+    Counts += Seconds*TIMER_HZ;
+#else
+    TIMER_READ(
+        Counts = TCNTx;
+        if( _BIT_ON(TIFRx,OCFAx) )  // Period ended, ISR pending
+            Counts = TCNTx + CLOCK_COUNT;
+
+        Counts += Timer.Wakeups*CLOCK_COUNT);
+#endif
+
+    return Counts;
+    }
+
+#ifdef TICKLESS_TIMER
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerNow - Return exact time since init
+//
+// The timer counts accumulated by the ISR, plus the live count in TCNT. If the
+//   period has ended but the ISR hasn't run yet (OCF set, as when called with
+//   interrupts off), the whole period is added in here instead.
+//
+// Inputs:      Ptr to seconds since init (returned)
+//
+// Outputs:     Timer counts within that second
+//
+static uint32_t TimerNow(TIME_T *Seconds) {
+    uint32_t Counts;
+    TIME_T   Secs;
+
+    TIMER_READ(
+        Counts = TCNTx;
+        if( _BIT_ON(TIFRx,OCFAx) )  // Period ended, ISR pending
+            Counts = TCNTx + (uint32_t) OCRAx + 1;
+
+        Counts += Timer.Counts;
+        Secs    = Timer.Seconds);
+
+    while( Counts >= TIMER_HZ ) {
+        Counts -= TIMER_HZ;
+        Secs++;
+        }
+
+    *Seconds = Secs;
+    return Counts;
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerSetDeadline - Set next deadline (tickless mode)
+//
+// The deadline is kept relative to the start of the current timer period, so
+//   the counts already elapsed in this period are added in. OCRA is then moved
+//   to the deadline, or to the end of the timer range if the deadline is
+//   further out than that.
+//
+// NOTE: Ticks*COUNTS_PER_TICK must fit in 32 bits (about 3 days at 15625 Hz)
+//
+// Inputs:      Ticks from now until the next deadline, or zero to cancel
+//
+// Outputs:     None.
+//
+void TimerSetDeadline(TIME_T Ticks) {
+    uint32_t Now;
+    bool     Pending;
+
+    DISABLE_INT;                    // Disable interrupts
+
+    Now     = TCNTx;
+    Pending = _BIT_ON(TIFRx,OCFAx);
+    if( Pending )                   // Period ended, ISR pending
+        Now = TCNTx + (uint32_t) OCRAx + 1;
+
+    Timer.Changed   = false;
+    Timer.Remaining = 0;
+
+    if( Ticks )
+        Timer.Remaining = Now + Ticks*COUNTS_PER_TICK;
+
+    //
+    // Move OCRA to the new deadline, unless the current period is about to
+    //   end (or already has). In that case the ISR will chain to the deadline.
+    //
+    // When the wait is split over two timer ranges, the first half can end
+    //   before TCNT. Stretch it to end just past TCNT, or if that doesn't fit
+    //   in the timer, leave OCRA alone and let the ISR chain from there.
+    //
+    if( !Pending && OCRAx >= Now + MIN_AHEAD ) {
+        uint32_t Period = TimerNextPeriod();
+
+        if( Timer.Remaining > MAX_PERIOD && Period < Now + MIN_AHEAD + 1 )
+            Period = Now + MIN_AHEAD + 1;
+
+        if( Period <= MAX_PERIOD && Period-1 >= Now + MIN_AHEAD )
+            OCRAx = Period-1;
+        }
+
+    ENABLE_INT;                     // Allow interrupts
+    }
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -193,11 +437,65 @@ uint16_t TimerGetMS(void) {
 //
 // Outputs:     None.
 //
+#ifdef TICKLESS_TIMER
+ISR(TIMER_ISR,ISR_NOBLOCK) {
+    uint32_t Period = (uint32_t) OCRAx + 1;
+
+    Timer.Wakeups++;
+    Timer.Sequence++;
+
+    //
+    // Account for the period that just ended
+    //
+    Timer.Counts += Period;
+    while( Timer.Counts >= TIMER_HZ ) {
+        Timer.Counts -= TIMER_HZ;
+        Timer.Seconds++;
+        }
+
+    //
+    // Chain to the next period, or flag the deadline
+    //
+    if( Timer.Remaining ) {
+        Timer.Remaining -= Period;
+        if( Timer.Remaining == 0 ) {
+            Timer.Changed = true;
+#ifdef POST_TimerEvent
+            EventPost(EVENT_TIMER);
+#endif
+            }
+        }
+
+    OCRAx = TimerNextPeriod()-1;
+    }
+#else
 ISR(TIMER_ISR,ISR_NOBLOCK) {
 
+    Timer.Wakeups++;
+    Timer.Sequence++;
+
     if( --Timer.Countdown != 0 )
         return;
 
     Timer.Countdown = TIMER_COUNT;
-    Timer.Changed   = true;
+
+    Timer.MS += MS_PER_TICK;
+    if( Timer.MS >= 1000 ) {
+        Timer.MS -= 1000;
+        Timer.Seconds++;
+        }
+
+    Timer.Changed = true;
+
+#ifdef POST_TimerEvent
+    EventPost(EVENT_TIMER);
+#endif
+
+    //
+    // Call the user's function
+    //
+#if defined(CALL_TimerISR) && defined(TIMER_ISR_CONTEXT)
+    TimerISR();
+#endif
     }
+#endif
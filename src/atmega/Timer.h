@@ -13,9 +13,10 @@
 //      //
 //      // In Timer.h
 //      //
-//      ...Choose a timer                  (Default: Timer0)
+//      ...Choose a timer                  (Default: Timer2)
+//      ...Choose tick duration            (Default: 40ms)
 //      ...Choose Polled or interrupt mode (Default: Interrupt)
-//      ...Choose tick duration            (Default: 15ms)
+//      ...Choose callback context         (Default: TimerUpdate)
 //
 //      //////////////////////////////////////
 //      //
@@ -53,6 +54,25 @@
 //      //
 //      TIME_T CurrentSecs = TimerGetSeconds(); // == Realtime seconds
 //      TIME_T CurrentMS   = TimerGetMS();      // == MS since second
+//      TIME_T Now         = TimerGetTime();    // == MS since init
+//
+//      //////////////////////////////////////
+//      //
+//      // Tickless mode (#define TICKLESS_TIMER)
+//      //
+//      void TimerISR(void) {               // Called once per deadline
+//          ...do update functions
+//          TimerSetDeadline(SECONDS(1));   // Schedule next wakeup
+//          }
+//
+//      TimerInit();                        // Called once at startup
+//      TimerSetDeadline(SECONDS(1));       // Schedule first wakeup
+//          :
+//
+//      while(1) {
+//          TimerUpdate();                  // Calls TimerISR at deadline
+//          sleep_cpu();                    // Sleeps until next event
+//          }
 //
 //  DESCRIPTION
 //
@@ -76,6 +96,26 @@
 //
 //      Additionally, the time (realtime) since reset may retrieved at any point.
 //
+//      The clock is advanced in the timer interrupt, so the time stays correct
+//        even if TimerUpdate() is called late. Reading the time does not mask
+//        the timer interrupt: the value is read repeatedly until the interrupt
+//        did not run during the read.
+//
+//      In tickless mode the timer does not interrupt at a fixed rate. Instead,
+//        the module remembers the next deadline and programs OCRA to expire
+//        exactly then, chaining several full timer periods together for waits
+//        longer than the timer can count. Between deadlines the CPU stays
+//        asleep, unless woken by some other interrupt.
+//
+//      The realtime clock stays exact in tickless mode: the seconds and MS are
+//        computed from the accumulated timer counts plus the live TCNT value.
+//
+//      TimerGetWakeups() returns the number of timer interrupts since init,
+//        which is a good proxy for the idle current drawn by the timer. The
+//        default config wakes 125 times/sec in tick mode; in tickless mode an
+//        8-bit timer wakes ~61 times/sec when idle, and a 16-bit timer once
+//        every 4 seconds, plus one wakeup per deadline.
+//
 //  EXAMPLE
 //
 //      //
@@ -141,54 +181,47 @@
 //
 // Specify a timer to use
 //
-// In addition to the timer, the user needs to define CLOCK_BITS, CLOCK_COUNT,
-//   and CTC_MODE specific to the selected timer.
-//
-// This is because the clock-select bits in TCCRB are *different*, depending
-//   on which timer you use. Also, some timers are 8 bits wide and some are
-//   16 bits wide, and there's no easy way for the program to tell.
-//
-// CTC_MODE is the bit combination needed to put the timer in CTC mode, as
-//   specified in the datasheet. It's a combination of the WGMxx bits.
-//
-// CLOCK_BITS is the F_CPU clock divisor you choose, as specified in the
-//   TCCRxB register. It's a combination of CSxx bits.
+// TIMER_ID is the hardware timer to use. Timers 1, 3, 4 and 5 are 16 bits wide,
+//   the others 8 bits wide.
 //
-// CSx2 CSx1 CSx0
-//    0    0    0  No clock source (Timer/Counter stopped).
-//    0    0    1  clk I/O /1    (No prescaling)
-//    0    1    0  clk I/O /8    (From prescaler)
-//    0    1    1  clk I/O /64   (From prescaler)
-//    1    0    0  clk I/O /256  (From prescaler)
-//    1    0    1  clk I/O /1024 (From prescaler)
-//    1    1    0  External clock on Tx pin. Clock on falling edge.
-//    1    1    1  External clock on Tx pin. Clock on rising edge.
+// TICKS_PER_SEC is the tick rate, and must evenly divide 1000 so that each tick
+//   is a whole number of milliseconds.
 //
-// CLOCK_COUNT is the number of clocks in one cycle of the counter (ie - the
-//   OCRA value to use)
+// TIMER_COUNT is the number of timer interrupts that make up 1 tick. Use this
+//   when a tick is too long for the timer to count in one period, as is the
+//   case for slow ticks on an 8-bit timer.
 //
-// TIMER_COUNT is the number of timer OCRA counts that make up 1 tick
+// The prescaler and OCRA value are computed from F_CPU at compile time, using
+//   the smallest prescaler that gives an exact tick. If no prescaler gives an
+//   exact tick within the range of the timer, compilation stops with an error.
 //
 // For example, a 40 mS tick on an arduino using timer 2:
 //
 //   #define TIMER_ID        2                           // use TIMER2
 //   #define TICKS_PER_SEC  25
-//   #define CLOCK_BITS      _PIN_MASK(_CS2(TIMER_ID)) |
-//                           _PIN_MASK(_CS1(TIMER_ID)) |
-//                           _PIN_MASK(_CS0(TIMER_ID))
-//   #define CTC_MODE        _PIN_MASK(_WGM1(TIMER_ID))
-//   #define CLOCK_COUNT     125
-//   #define TIMER_COUNT     5
+//   #define TIMER_COUNT     5                           // => /1024, OCRA 124
+//
+// Or a 1 mS tick using timer 1:
+//
+//   #define TIMER_ID        1                           // use TIMER1
+//   #define TICKS_PER_SEC   1000
+//   #define TIMER_COUNT     1                           // => /1, OCRA 15999
 //
 #define TIMER_ID        2                           // use TIMER2
-
-#define CLOCK_BITS      _PIN_MASK(_CS2(TIMER_ID)) | \
-                        _PIN_MASK(_CS1(TIMER_ID)) | \
-                        _PIN_MASK(_CS0(TIMER_ID))
-#define CTC_MODE        _PIN_MASK(_WGM1(TIMER_ID))
-#define CLOCK_COUNT     125
-#define TIMER_COUNT     5
 #define TICKS_PER_SEC   25
+#define TIMER_COUNT     5
+
+//
+// Tickless mode depends on the next definition.
+//
+// Defined (ie - uncommented) means the timer only interrupts when the deadline
+//   set by TimerSetDeadline() expires (or when the timer wraps), instead of at
+//   every tick. TimerUpdate() returns TRUE (and calls TimerISR) only once per
+//   deadline.
+//
+// Use a 16-bit timer and TIMER_COUNT 1 for the fewest wakeups.
+//
+//#define TICKLESS_TIMER
 
 //
 // Polled mode/ISR mode depends on the next definition.
@@ -201,6 +234,26 @@
 //
 #define CALL_TimerISR
 
+//
+// Callback context depends on the next definition.
+//
+// Defined (ie - uncommented) means TimerISR is called directly from the timer
+//   interrupt at each tick. Undefined (commented out) means TimerISR is called
+//   from TimerUpdate(), at main level.
+//
+// Only has effect if CALL_TimerISR is defined. Not available in tickless mode.
+//
+//#define TIMER_ISR_CONTEXT
+
+//
+// Event loop posting depends on the next definition.
+//
+// Defined (ie - uncommented) means post EVENT_TIMER at each tick (or each
+//   deadline in tickless mode). The handler should call TimerUpdate(). See
+//   Event.h
+//
+//#define POST_TimerEvent
+
 //
 // End of user configurable options
 //
@@ -216,6 +269,73 @@
 
 #define MS_PER_TICK         (1000/TICKS_PER_SEC)
 
+#if (1000 % TICKS_PER_SEC) != 0
+#error "Timer: TICKS_PER_SEC must evenly divide 1000"
+#endif
+
+#if defined(TICKLESS_TIMER) && defined(TIMER_ISR_CONTEXT)
+#error "Timer: TIMER_ISR_CONTEXT is not available in tickless mode"
+#endif
+
+//
+// Timer width
+//
+#if TIMER_ID == 1 || TIMER_ID == 3 || TIMER_ID == 4 || TIMER_ID == 5
+#define TIMER_MAX           65535UL
+#else
+#define TIMER_MAX           255UL
+#endif
+
+//
+// Pick the smallest prescaler giving an exact tick that fits in the timer.
+//
+// CLOCK_SELECT is the CSx2:0 value for that prescaler, which is different for
+//   timer 2 than for the others.
+//
+#define _TIMER_DIV(_p_)     ((_p_)*TICKS_PER_SEC*TIMER_COUNT)
+#define _TIMER_FITS(_p_)    ((F_CPU % _TIMER_DIV(_p_)) == 0 && (F_CPU/_TIMER_DIV(_p_)) <= TIMER_MAX+1)
+
+#if   _TIMER_FITS(1UL)
+#define CLOCK_PRESCALE      1UL
+#define CLOCK_SELECT        1
+#elif _TIMER_FITS(8UL)
+#define CLOCK_PRESCALE      8UL
+#define CLOCK_SELECT        2
+#elif _TIMER_FITS(32UL) && TIMER_ID == 2
+#define CLOCK_PRESCALE      32UL
+#define CLOCK_SELECT        3
+#elif _TIMER_FITS(64UL)
+#define CLOCK_PRESCALE      64UL
+#if TIMER_ID == 2
+#define CLOCK_SELECT        4
+#else
+#define CLOCK_SELECT        3
+#endif
+#elif _TIMER_FITS(128UL) && TIMER_ID == 2
+#define CLOCK_PRESCALE      128UL
+#define CLOCK_SELECT        5
+#elif _TIMER_FITS(256UL)
+#define CLOCK_PRESCALE      256UL
+#if TIMER_ID == 2
+#define CLOCK_SELECT        6
+#else
+#define CLOCK_SELECT        4
+#endif
+#elif _TIMER_FITS(1024UL)
+#define CLOCK_PRESCALE      1024UL
+#if TIMER_ID == 2
+#define CLOCK_SELECT        7
+#else
+#define CLOCK_SELECT        5
+#endif
+#else
+#error "Timer: no prescaler gives an exact tick, change TICKS_PER_SEC or TIMER_COUNT"
+#endif
+
+#define TIMER_HZ            (F_CPU/CLOCK_PRESCALE)          // Timer counts per second
+#define CLOCK_COUNT         (TIMER_HZ/(TICKS_PER_SEC*TIMER_COUNT))
+#define COUNTS_PER_TICK     (TIMER_HZ/TICKS_PER_SEC)
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -252,6 +372,61 @@ bool TimerUpdate(void);
 TIME_T      TimerGetSeconds(void);
 uint16_t    TimerGetMS(void);
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerGetTime - Return MS since TimerInit()
+//
+// Seconds and MS read together, for measuring intervals. Wraps after 49 days.
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+TIME_T      TimerGetTime(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerGetWakeups - Return number of timer interrupts since TimerInit()
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint32_t    TimerGetWakeups(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerGetCounts - Return timer counts since TimerInit()
+//
+// The raw timer count (TIMER_HZ per second), for measuring short intervals. Wraps
+//   every 2^32 counts, so take differences (unsigned subtraction) rather than
+//   comparing values.
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+uint32_t    TimerGetCounts(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerSetDeadline - Set next deadline (tickless mode)
+//
+// Inputs:      Ticks from now until the next deadline (ie - SECONDS(3)), or
+//                zero to cancel the pending deadline.
+//
+// Outputs:     None.
+//
+// NOTE: Only defined if TICKLESS_TIMER is #defined, see above.
+//
+#ifdef TICKLESS_TIMER
+void TimerSetDeadline(TIME_T Ticks);
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -263,6 +438,11 @@ uint16_t    TimerGetMS(void);
 //
 // NOTE: Only defined if CALL_TimerISR is #defined, see above.
 //
+// NOTE: In tickless mode, called once per deadline instead of once per tick.
+//
+// NOTE: Called from interrupt context if TIMER_ISR_CONTEXT is #defined, otherwise
+//         from TimerUpdate().
+//
 #ifdef CALL_TimerISR
 void TimerISR(void);
 #endif
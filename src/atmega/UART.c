@@ -74,6 +74,11 @@
 
 #include "PortMacros.h"
 #include "UART.h"
+#include "Profile.h"
+
+#ifdef POST_UARTEvent
+#include "Event.h"
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -240,6 +245,8 @@ ISR(RX_VECT) {
     uint8_t NewIn;
     char    NewChar;
 
+    PROFILE_ISR(PROFILE_UART_RX);
+
     NewChar = UDR0;                         // Get data, clear errors
 
     //
@@ -250,6 +257,9 @@ ISR(RX_VECT) {
     if( NewIn != UART.Rx_FIFO_Out ) {
         UART.Rx_FIFO[UART.Rx_FIFO_In] = NewChar;
         UART.Rx_FIFO_In               = NewIn;
+#ifdef POST_UARTEvent
+        EventPost(EVENT_UART);
+#endif
         }
 
     //
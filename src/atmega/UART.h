@@ -92,6 +92,14 @@
 #define OFIFO_SIZE      (1 << 6)        // == 64 chars Tx FIFO
 #endif
 
+//
+// Event loop posting depends on the next definition.
+//
+// Defined (ie - uncommented) means post EVENT_UART for each received char.
+//   See Event.h
+//
+//#define POST_UARTEvent
+
 //
 // End of user configurable options
 //
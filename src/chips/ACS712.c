@@ -43,6 +43,7 @@
 #include <string.h>
 
 #include "PortMacros.h"
+#include "AtoDShare.h"
 #include "ACS712.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,8 +70,15 @@ static struct {
 #define START_ATOD  { _SET_BIT(ADCSRA,ADSC); }      // Start the AtoD conversion
 #define ADMUX_VAL   (_PIN_MASK(REFS0) + ACS712_CHANNEL)
 
-#define DISABLE_INT _CLR_BIT(ADCSRA,_PIN_MASK(ADIE));   // Disable AtoD interrupts
-#define ENABLE_INT  _SET_BIT(ADCSRA,_PIN_MASK(ADIE));   // Enable  AtoD interrupts
+#ifdef ATOD_SHARED
+#define DISABLE_INT uint8_t SaveSREG = SREG; cli();     // ADC ISR is shared
+#define ENABLE_INT  SREG = SaveSREG;                    // Restore, may be called with ints off
+#else
+#define DISABLE_INT _CLR_BIT(ADCSRA,ADIE);              // Disable AtoD interrupts
+#define ENABLE_INT  _SET_BIT(ADCSRA,ADIE);              // Enable  AtoD interrupts
+#endif
+
+static void ACS712Sample(uint16_t Sample);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -87,6 +95,14 @@ void ACS712Init(void) {
 
     ACS712.SkipCount = ACS712_SKIP;
 
+#ifdef ATOD_SHARED
+    //
+    // AtoDShare converts us in 1 of every ACS712_SKIP slots
+    //
+    ATOD_CLIENT Client = { ADMUX_VAL, ATOD_PRESCALE_128, ACS712_SKIP, ACS712Sample };
+
+    AtoDShareAdd(&Client);
+#else
     //
     // Setup AtoD channels for input
     //
@@ -105,6 +121,7 @@ void ACS712Init(void) {
     // Start the conversions
     //
     START_ATOD;
+#endif
     }
 
 
@@ -163,6 +180,23 @@ void ACS712Update(void) {
 uint16_t ACS712GetCurrent(void) { return ACS712.Current; }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ACS712Sample - Total up one AtoD sample
+//
+// Inputs:      AtoD result
+//
+// Outputs:     None.
+//
+static void ACS712Sample(uint16_t Sample) {
+
+    ACS712.Cycles++;
+    ACS712.Total += Sample;
+    }
+
+
+#ifndef ATOD_SHARED
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -190,6 +224,6 @@ ISR(ADC_vect,ISR_NOBLOCK) {
     //
     // Total up the count and return
     //
-    ACS712.Cycles++;
-    ACS712.Total += ADC;
+    ACS712Sample(ADC);
     }
+#endif
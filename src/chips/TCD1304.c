@@ -46,6 +46,7 @@
 #include "TCD1304.h"
 
 #include "PortMacros.h"
+#include "AtoDShare.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -95,6 +96,7 @@ void TCD1304Init(void) {
     TCD_CLK_DN;
     TCD_SHUT_DN;
 
+#ifndef ATOD_SHARED
     //
     // Setup AtoD channels for input
     //
@@ -114,6 +116,7 @@ void TCD1304Init(void) {
 
     ADCSRA = _PIN_MASK(ADPS1) |
              _PIN_MASK(ADEN);                        // Enable, Enable int
+#endif
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -151,6 +154,10 @@ void TCD1304Read(void) {
 
     memset(TCD1304Data,0,sizeof(TCD1304Data));
 
+#ifdef ATOD_SHARED
+    AtoDShareLock(ADMUX_VAL,ATOD_PRESCALE_4);   // Hold the ADC for the whole scanline
+#endif
+
     cli();
 
     TCD_CLK_UP;
@@ -224,4 +231,8 @@ void TCD1304Read(void) {
     CLOCK;
 
     sei();
+
+#ifdef ATOD_SHARED
+    AtoDShareUnlock();
+#endif
     }
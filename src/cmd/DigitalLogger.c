@@ -61,7 +61,7 @@
 #include "UART.h"
 #include "Serial.h"
 #include "Limit.h"
-#include "TimerB.h"
+#include "Timer.h"
 #include "PortMacros.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -81,7 +81,7 @@ MAIN main(void) {
     _CLR_BIT(MCUCR,PUD);                // Allow I/O pullups
 
     LimitInit();                        // Initialize debounce system
-    TimerBInit();                       // For timestamp and updates
+    TimerInit();                        // For timestamp and updates
     UARTInit();                         // For serial I/O
 
     set_sleep_mode(SLEEP_MODE_IDLE);
@@ -95,8 +95,10 @@ MAIN main(void) {
     //
     // All done with init,
     // 
-    while(1)
+    while(1) {
         sleep_cpu();
+        TimerUpdate();                  // Calls TimerISR at each tick
+        }
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -109,7 +111,7 @@ MAIN main(void) {
 // Outputs:     None.
 //
 void LimitISR(uint8_t Limits) {
-    TIME_T Time = TimerBGetSeconds();
+    TIME_T Time = TimerGetSeconds();
     uint8_t Secs, Mins, Hrs, Days;
 
     Secs = Time % 60;
@@ -146,12 +148,12 @@ void LimitISR(uint8_t Limits) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBISR - Called by the timer section once a tick
+// TimerISR - Called by the timer section once a tick
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
-void TimerBISR(void) {
+void TimerISR(void) {
     LimitUpdate(MS_PER_TICK);
     }
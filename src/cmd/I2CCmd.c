@@ -53,6 +53,7 @@
 #include "UART.h"
 #include "Serial.h"
 #include "I2C.h"
+#include "Thread.h"
 #include "GetLine.h"
 #include "Parse.h"
 #include "VT100.h"
@@ -84,6 +85,10 @@ char    *Token;
 
 uint8_t OurAddr = OUR_I2C_ADDR;
 
+static THREAD_T Scan;                   // Bus scan, runs in background
+
+static THREAD_STATUS ScanThread(THREAD_T *Thread);
+
 //
 // Static layout of the help screen
 //
@@ -155,6 +160,12 @@ MAIN main(void) {
         // Process user commands
         //
         ProcessSerialInput(GetUARTByte());
+
+        //
+        // Continue the bus scan, if one is in progress
+        //
+        if( THREAD_RUNNING(&Scan) )
+            ScanThread(&Scan);
         } 
     }
 
@@ -317,6 +328,47 @@ static void PrintResults(bool PrintBuffer) {
     }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScanThread - Scan for slaves by reading register (default: Reg 0)
+//
+// Runs as a stackless thread from the main loop, giving up the CPU while each
+//   transfer is in progress so the command line stays live.
+//
+// Inputs:      Ptr to thread state
+//
+// Outputs:     THREAD_WAITING while the scan is in progress
+//              THREAD_DONE    when complete
+//
+static THREAD_STATUS ScanThread(THREAD_T *Thread) {
+
+    THREAD_BEGIN(Thread);
+
+    nSlaves = 0;
+    PrintString("Addr: Result\r\n");
+    for( SlaveAddr = 0; SlaveAddr <= 127; SlaveAddr++ ) {
+        GetI2C(SlaveAddr,1,Buffer);
+        THREAD_WAIT_I2C(Thread);
+        Status = I2CStatus();
+        if( Status == I2C_NO_SLAVE_ACK )
+            continue;
+        PrintH(SlaveAddr);
+        PrintString("  : ");
+        PrintString(StatusText[Status-I2C_COMPLETE]);
+        PrintCRLF();
+        if( Status != I2C_NO_SLAVE_ACK )
+            nSlaves++;
+        }
+    PrintD(nSlaves,0);
+    PrintString(" responses\r\n");
+    PrintCRLF();
+    DumpDebug();
+
+    THREAD_END(Thread);
+    }
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -332,6 +384,15 @@ void SerialCommand(char *Line) {
     ParseInit(Line);
     Command = ParseToken();
 
+    //
+    // Bus commands must wait for a scan in progress to finish
+    //
+    if( THREAD_RUNNING(&Scan) && !StrEQ(Command,"H") && !StrEQ(Command,"?") ) {
+        PrintString("Scan in progress\r\n");
+        PrintCRLF();
+        return;
+        }
+
     //
     // R - Read bytes from slave
     //
@@ -399,24 +460,7 @@ void SerialCommand(char *Line) {
     // S - Scan for slaves by reading register (default: Reg 0)
     //
     if( StrEQ(Command,"S") ) {
-        nSlaves = 0;
-        PrintString("Addr: Result\r\n");
-        for( SlaveAddr = 0; SlaveAddr <= 127; SlaveAddr++ ) {
-            GetI2CW(SlaveAddr,1,Buffer);
-            Status = I2CStatus();
-            if( Status == I2C_NO_SLAVE_ACK )
-                continue;
-            PrintH(SlaveAddr);
-            PrintString("  : ");
-            PrintString(StatusText[Status-I2C_COMPLETE]);
-            PrintCRLF();
-            if( Status != I2C_NO_SLAVE_ACK )
-                nSlaves++;
-            }
-        PrintD(nSlaves,0);
-        PrintString(" responses\r\n");
-        PrintCRLF();
-        DumpDebug();
+        THREAD_INIT(&Scan);
         return;
         }
 
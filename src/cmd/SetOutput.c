@@ -57,15 +57,14 @@
 #include <avr/interrupt.h>
 #include <avr/sleep.h>
 
-#define __DELAY_BACKWARD_COMPATIBLE__
-#include <util/delay.h>
-
 #include <ctype.h>
 #include <stdbool.h>
 
 #include "PortMacros.h"
 #include "UART.h"
 #include "Serial.h"
+#include "Timer.h"
+#include "StepPulse.h"
 
 #define STP_PORT    D               // Use PORTD
 #define STP_PIN     7               // Step is on pin 7
@@ -97,17 +96,9 @@ static const char Help[] PROGMEM = \
 "\r\n"
 ;
 
-static bool Continuous = false;
 #define ESC     '\033'
 
-int StepDelay;
-
-#define PULSE {                                                                         \
-    _SET_BIT(_PORT(STP_PORT),STP_PIN);                                                  \
-    _delay_ms(StepDelay);                                                               \
-    _CLR_BIT(_PORT(STP_PORT),STP_PIN);                                                  \
-    _delay_ms(StepDelay);                                                               \
-    }                                                                                   \
+static STEP_PULSE Pulses;
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -150,11 +141,11 @@ void ProcessInput(char InChar) {
         // + - Go faster (by 10%)
         //
         case '+':
-            StepDelay -= (StepDelay+9)/10;
-            if( StepDelay == 0 )
-                StepDelay = 1;
+            Pulses.Delay -= (Pulses.Delay+9)/10;
+            if( Pulses.Delay == 0 )
+                Pulses.Delay = 1;
             PrintString("Step delay ");
-            PrintD(StepDelay,0);
+            PrintD(Pulses.Delay,0);
             PrintString(" ms\r\n");
             return;
             break;
@@ -163,9 +154,9 @@ void ProcessInput(char InChar) {
         // - - Go slower (by 10%)
         //
         case '-':
-            StepDelay += (StepDelay+9)/10;
+            Pulses.Delay += (Pulses.Delay+9)/10;
             PrintString("Step delay ");
-            PrintD(StepDelay,0);
+            PrintD(Pulses.Delay,0);
             PrintString(" ms\r\n");
             return;
             break;
@@ -228,7 +219,7 @@ void ProcessInput(char InChar) {
         // P - Send pulse
         //
         case 'P':
-            PULSE;
+            StepPulseSend(&Pulses);
             PrintString("Pulse\r\n");
             return;
             break;
@@ -237,7 +228,7 @@ void ProcessInput(char InChar) {
         // C - Set for continuous pulses
         //
         case 'C':
-            Continuous = true;
+            StepPulseStart(&Pulses);
             PrintString("Continuous pulses (ESC to stop)\r\n");
             return;
             break;
@@ -246,7 +237,7 @@ void ProcessInput(char InChar) {
         // ESC - Escape from continuous mode
         //
         case ESC:
-            Continuous = false;
+            StepPulseStop(&Pulses);
             PrintString("Stop\r\n");
             return;
             break;
@@ -300,9 +291,8 @@ MAIN main(void) {
     sleep_enable();
 
     UARTInit();
-
-    Continuous = false;
-    StepDelay  = 100;
+    TimerInit();
+    StepPulseInit(&Pulses,&_PORT(STP_PORT),_PIN_MASK(STP_PIN),100);
 
     sei();                              // Enable interrupts
 
@@ -322,8 +312,12 @@ MAIN main(void) {
     while(1) {
         char InChar;
 
-        if( Continuous ) PULSE
-        else             sleep_cpu();      // Wait for typed char
+        if( StepPulseRunning(&Pulses) )
+            StepPulseThread(&Pulses);   // Returns at once while waiting
+        else
+            sleep_cpu();                // Wait for typed char or tick
+
+        TimerUpdate();
 
         //
         // Process characters as received
@@ -333,3 +327,16 @@ MAIN main(void) {
 
         } 
     }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Nothing to do - the pulse thread reads the timer directly.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {}
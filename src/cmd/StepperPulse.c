@@ -56,15 +56,14 @@
 #include <avr/sleep.h>
 
 
-#define __DELAY_BACKWARD_COMPATIBLE__
-#include <util/delay.h>
-
 #include <ctype.h>
 #include <stdbool.h>
 
 #include "PortMacros.h"
 #include "UART.h"
 #include "Serial.h"
+#include "Timer.h"
+#include "StepPulse.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -104,28 +103,9 @@ static const char Help[] PROGMEM =
 "\r\n"
 ;
 
-static bool Continuous = false;
-#define ESC     '/033'
-
-int StepDelay;
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//
-// Pulse - Send 1 motor step pulse
-//
-// Inputs:      None.
-//
-// Outputs:     None.
-//
-void Pulse(void) {
-
-    _SET_BIT(_PORT(STP_PORT),STP_PIN);
-    _delay_ms(StepDelay);
-    _CLR_BIT(_PORT(STP_PORT),STP_PIN);
-    _delay_ms(StepDelay);
-    }
+#define ESC     '\033'
 
+static STEP_PULSE Pulses;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -143,7 +123,7 @@ void PrintSettings(void) {
     PrintString(", DIR ");
     PrintString(_BIT_ON(_PORT(DIR_PORT),DIR_PIN) ? "Rev" : "Fwd");
     PrintString(", Step delay ");
-    PrintD(StepDelay,0);
+    PrintD(Pulses.Delay,0);
     PrintString(" ms\r\n");
     }
 
@@ -188,9 +168,9 @@ void ProcessInput(char InChar) {
         // + - Go faster (by 10%)
         //
         case '+':
-            StepDelay -= (StepDelay+9)/10;
-            if( StepDelay == 0 )
-                StepDelay = 1;
+            Pulses.Delay -= (Pulses.Delay+9)/10;
+            if( Pulses.Delay == 0 )
+                Pulses.Delay = 1;
             PrintSettings();
             return;
             break;
@@ -199,7 +179,7 @@ void ProcessInput(char InChar) {
         // - - Go slower (by 10%)
         //
         case '-':
-            StepDelay += (StepDelay+9)/10;
+            Pulses.Delay += (Pulses.Delay+9)/10;
             PrintSettings();
             return;
             break;
@@ -262,7 +242,7 @@ void ProcessInput(char InChar) {
         // P - Send pulse
         //
         case 'P':
-            Pulse();
+            StepPulseSend(&Pulses);
             PrintString("Pulse\r\n");
             return;
             break;
@@ -271,7 +251,7 @@ void ProcessInput(char InChar) {
         // C - Set for continuous pulses
         //
         case 'C':
-            Continuous = true;
+            StepPulseStart(&Pulses);
             PrintSettings();
             PrintString("Continuous pulses (ESC to stop)\r\n\r\n");
             return;
@@ -281,7 +261,7 @@ void ProcessInput(char InChar) {
         // ESC - Escape from continuous mode
         //
         case ESC:
-            Continuous = false;
+            StepPulseStop(&Pulses);
             PrintString("Stop\r\n");
             return;
             break;
@@ -337,9 +317,8 @@ MAIN main(void) {
     sleep_enable();
 
     UARTInit();
-
-    Continuous = false;
-    StepDelay  = 100;
+    TimerInit();
+    StepPulseInit(&Pulses,&_PORT(STP_PORT),_PIN_MASK(STP_PIN),100);
 
     sei();                              // Enable interrupts
 
@@ -359,8 +338,12 @@ MAIN main(void) {
     while(1) {
         char InChar;
 
-        if( Continuous ) Pulse();
-        else             sleep_cpu();      // Wait for typed char
+        if( StepPulseRunning(&Pulses) )
+            StepPulseThread(&Pulses);   // Returns at once while waiting
+        else
+            sleep_cpu();                // Wait for typed char or tick
+
+        TimerUpdate();
 
         //
         // Process characters as received
@@ -370,3 +353,16 @@ MAIN main(void) {
 
         } 
     }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Nothing to do - the pulse thread reads the timer directly.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {}
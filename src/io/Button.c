@@ -44,6 +44,10 @@
 #include "Button.h"
 #include "PortMacros.h"
 
+#ifdef POST_ButtonEvent
+#include "Event.h"
+#endif
+
 #ifndef CALL_ButtonISR
 volatile uint8_t ButtonValue;       // Button states
 volatile bool    ButtonChange;      // TRUE if changed from last state
@@ -140,5 +144,9 @@ void ButtonUpdate(uint8_t MS) {
     ButtonValue  = ButtonMirror;
     ButtonChange = true;
 #endif
+
+#ifdef POST_ButtonEvent
+    EventPost(EVENT_BUTTON);
+#endif
     }
 
@@ -181,6 +181,14 @@
 // 
 #define CALL_ButtonISR
 
+//
+// Event loop posting depends on the next definition.
+//
+// Defined (ie - uncommented) means post EVENT_BUTTON when the debounced
+//   buttons change. See Event.h
+//
+//#define POST_ButtonEvent
+
 //
 // End of user configurable options
 //
@@ -40,6 +40,7 @@
 #include "Servo.h"
 #include "PortMacros.h"
 #include "TimerMacros.h"
+#include "Profile.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -196,6 +197,8 @@ uint8_t GetServo(uint8_t ID) {
 //
 ISR(TIMER_ISRA,ISR_BLOCK) {
 
+    PROFILE_ISR(PROFILE_SERVO);
+
     OFloCount--;
 
     //
@@ -249,6 +252,8 @@ ISR(TIMER_ISRB,ISR_BLOCK) {
     uint8_t CurrentPos = TCNT2;
     uint8_t NextPos    = SERVO_COUNTA;
 
+    PROFILE_ISR(PROFILE_SERVO);
+
     //
     // For some reason, the match on OCRA seems to trigger a corresponding
     //   match on OCRB in all cases (with TCNT2 == 0).
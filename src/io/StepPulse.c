@@ -1,19 +1,15 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//      Copyright (C) 2010 Peter Walsh, Milford, NH 03055
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
 //      All Rights Reserved under the MIT license as outlined below.
 //
 //  FILE
-//      Timer.c
+//      StepPulse.c
 //
-//  DESCRIPTION
+//  SYNOPSIS
 //
-//      Timer processing
-//
-//      Setup a timer as a real time timer, to manage timed events.
-//
-//      See Timer.h for an in-depth description
+//      See StepPulse.h for a complete description
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -39,121 +35,101 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#include <string.h>
-
 #include <avr/io.h>
-#include <avr/interrupt.h>
 
+#include "PortMacros.h"
 #include "Timer.h"
-#include "TimerMacros.h"
-
-#ifndef CALL_TimerISR
-volatile bool   TimerChanged   
-    __attribute__ ((section (".noinit")));;     // Set TRUE at each tick
-#endif
-
-static struct {
-    TIME_T  Seconds;                            // Seconds since init
-    TIME_T  MS;                                 // MS within second
-    } Timer NOINIT;
+#include "StepPulse.h"
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// Setup some port designations
+// MS to timer counts, in 32 bits. Above 64K counts per second the timer rate is a
+//   multiple of 1000 (F_CPU / 1, 8, 64) for any usual F_CPU.
 //
-#define PRTIMx      _PRTIM(TIMER_ID)
-#define TIMER_ISR   _TCOMPA_VECT(TIMER_ID)
-
-#define TCNTx       _TCNT(TIMER_ID)
-#define OCRAx       _OCRA(TIMER_ID)
-
-#define TCCRAx      _TCCRA(TIMER_ID)
-#define TCCRBx      _TCCRB(TIMER_ID)
-#define TIMSKx      _TIMSK(TIMER_ID)
-#define OCIEAx      _OCIEA(TIMER_ID)
+#if TIMER_HZ <= 65536UL
+#define MS_TO_COUNTS(_ms_)  (((uint32_t) (_ms_)*TIMER_HZ)/1000)
+#else
+#define MS_TO_COUNTS(_ms_)  ((uint32_t) (_ms_)*(TIMER_HZ/1000))
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerInit - Initialize timer system
+// StepPulseInit - Initialize step pulses
 //
-// Inputs:      None.
+// Inputs:      Ptr to pulse state
+//              Ptr to PORTx register of the step pin
+//              Mask of step pin
+//              MS high, then MS low of each pulse
 //
 // Outputs:     None.
 //
-void TimerInit(void) {
+void StepPulseInit(STEP_PULSE *Pulse,volatile uint8_t *Port,uint8_t Mask,uint16_t Delay) {
 
-    memset(&Timer,0,sizeof(Timer));
-
-    _CLR_BIT(PRR,PRTIMx);           // Powerup the clock
-
-    //
-    // Setup the timer as free running, with OCRA as top value
-    //
-    TCCRAx = CTC_MODE;              // No output compare functions
-    TCCRBx = CLOCK_BITS;            // Set appropriate clock
-    OCRAx  = CLOCK_COUNT;           // And clock count for ticks
-    TCNTx  = 0;
-    TIMSKx = _PIN_MASK(OCIEAx);     // Allow interrupts
+    Pulse->Port       = Port;
+    Pulse->Mask       = Mask;
+    Pulse->Delay      = Delay;
+    Pulse->Continuous = false;
+    THREAD_STOP(&Pulse->Thread);
     }
 
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerGetSeconds - Return seconds since TimerBInit()
-// TimerGetMS      - Get milliseconds since previous second
+// StepPulseSend  - Send 1 step pulse
+// StepPulseStart - Start continuous pulses
+// StepPulseStop  - Stop continuous pulses, after the current one
 //
-// Inputs:      None.
+// Inputs:      Ptr to pulse state
 //
-// Outputs:     The value specified.
+// Outputs:     None.
 //
-TIME_T TimerGetSeconds(void) {
-    TIME_T Rtnval;
+void StepPulseSend(STEP_PULSE *Pulse) {
 
-    TIMSKx = 0;                     // Disable interrupts
-    Rtnval = Timer.Seconds;
-    TIMSKx = _PIN_MASK(OCIEAx);     // Allow interrupts
+    if( StepPulseRunning(Pulse) )
+        return;
 
-    return Rtnval;
+    Pulse->Continuous = false;
+    THREAD_INIT(&Pulse->Thread);
     }
 
-TIME_T TimerGetMS(void) {
-    TIME_T Rtnval;
-
-    TIMSKx = 0;                     // Disable interrupts
-    Rtnval = Timer.MS;
-    TIMSKx = _PIN_MASK(OCIEAx);     // Allow interrupts
+void StepPulseStart(STEP_PULSE *Pulse) {
 
-    return Rtnval;
+    Pulse->Continuous = true;
+    if( !StepPulseRunning(Pulse) )
+        THREAD_INIT(&Pulse->Thread);
     }
 
+void StepPulseStop(STEP_PULSE *Pulse) { Pulse->Continuous = false; }
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TIMERx_COMPA_vect - Compare A causes a timer tick
+// StepPulseThread - Send pulses until stopped
 //
-// This defines the "tick" of the system clock. Increment the global
-//   clock counter, call the user's function (if defined) and return.
+// Yields to the main loop during each delay, so the caller can process commands
+//   while a pulse is being sent. A stop ends the pulses with the pin low.
 //
-// Inputs:      None. (ISR)
+// Inputs:      Ptr to pulse state
 //
-// Outputs:     None.
+// Outputs:     THREAD_WAITING while pulses are being sent
+//              THREAD_DONE    when finished
 //
-ISR(TIMER_ISR,ISR_NOBLOCK) {
+THREAD_STATUS StepPulseThread(STEP_PULSE *Pulse) {
+    THREAD_T *Thread = &Pulse->Thread;
 
-    Timer.MS += MS_PER_TICK;
+    THREAD_BEGIN(Thread);
 
-    if( Timer.MS >= 1000 ) {
-        ++Timer.Seconds;
-        Timer.MS -= 1000;
-        }
+    do {
+        *Pulse->Port |= Pulse->Mask;
+        Pulse->Start  = TimerGetCounts();
+        THREAD_WAIT_UNTIL(Thread,TimerGetCounts() - Pulse->Start >= MS_TO_COUNTS(Pulse->Delay));
 
-    //
-    // Call the user's function
-    //
-#ifdef CALL_TimerISR
-    TimerISR();
-#else
-    TimerChanged = true;
-#endif
+        *Pulse->Port &= ~Pulse->Mask;
+        Pulse->Start  = TimerGetCounts();
+        THREAD_WAIT_UNTIL(Thread,TimerGetCounts() - Pulse->Start >= MS_TO_COUNTS(Pulse->Delay));
+        } while( Pulse->Continuous );
+
+    THREAD_END(Thread);
     }
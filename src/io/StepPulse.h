@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      StepPulse.h
+//
+//  SYNOPSIS
+//
+//      //////////////////////////////////////
+//      //
+//      // In Main.c
+//      //
+//      static STEP_PULSE Pulses;
+//
+//      _SET_BIT(_DDR(STP_PORT),STP_PIN);   // Step pin is an output
+//      StepPulseInit(&Pulses,&_PORT(STP_PORT),_PIN_MASK(STP_PIN),100);
+//          :
+//
+//      StepPulseSend(&Pulses);             // Send 1 pulse
+//      StepPulseStart(&Pulses);            // Start continuous pulses
+//      StepPulseStop(&Pulses);             // Stop after the current pulse
+//
+//      while(1) {
+//          if( StepPulseRunning(&Pulses) )
+//              StepPulseThread(&Pulses);   // Returns at once while waiting
+//          else
+//              sleep_cpu();                // Nothing to do, wait for input
+//              :
+//          }
+//
+//  DESCRIPTION
+//
+//      Step pulses on a GPIO pin, sent from a thread
+//
+//      Each pulse is Delay MS high, then Delay MS low. The pulses are sent by a
+//        stackless thread (see Thread.h), which yields to the main loop for the
+//        whole of each delay. Commands such as "stop" are processed while a pulse
+//        is being sent, and take effect at the end of it.
+//
+//      The delays are timed with TimerGetCounts(), not the timer tick, so a pulse
+//        is accurate to one timer count (64 uS with the default Timer.h settings)
+//        rather than to 40 MS.
+//
+//  NOTES
+//
+//      Needs TimerInit(), and the program must supply TimerISR() (see Timer.h).
+//
+//      The thread has to be polled to end each delay on time, so the main loop
+//        mustn't sleep while pulses are running.
+//
+//      Delay can be changed at any time, and applies to the delay in progress.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STEPPULSE_H
+#define STEPPULSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "Thread.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data definitions and macros
+//
+typedef struct {
+    volatile uint8_t   *Port;                   // PORTx of the step pin
+    uint8_t             Mask;                   // Step pin mask
+    uint16_t            Delay;                  // MS high, then MS low
+    bool                Continuous;             // FALSE to stop after this pulse
+    uint32_t            Start;                  // TimerGetCounts() at start of delay
+    THREAD_T            Thread;                 // Pulse thread
+    } STEP_PULSE;
+
+#define StepPulseRunning(_p_)   THREAD_RUNNING(&(_p_)->Thread)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StepPulseInit - Initialize step pulses
+//
+// Inputs:      Ptr to pulse state
+//              Ptr to PORTx register of the step pin
+//              Mask of step pin
+//              MS high, then MS low of each pulse
+//
+// Outputs:     None.
+//
+void StepPulseInit(STEP_PULSE *Pulse,volatile uint8_t *Port,uint8_t Mask,uint16_t Delay);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StepPulseSend  - Send 1 step pulse
+// StepPulseStart - Start continuous pulses
+// StepPulseStop  - Stop continuous pulses, after the current one
+//
+// These only set up the thread, which sends the pulses when polled. Send and
+//   start do nothing if pulses are already being sent.
+//
+// Inputs:      Ptr to pulse state
+//
+// Outputs:     None.
+//
+void StepPulseSend (STEP_PULSE *Pulse);
+void StepPulseStart(STEP_PULSE *Pulse);
+void StepPulseStop (STEP_PULSE *Pulse);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StepPulseThread - Send pulses until stopped
+//
+// Inputs:      Ptr to pulse state
+//
+// Outputs:     THREAD_WAITING while pulses are being sent
+//              THREAD_DONE    when finished
+//
+THREAD_STATUS StepPulseThread(STEP_PULSE *Pulse);
+
+#endif  // STEPPULSE_H - entire file
@@ -35,6 +35,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
+
 #include <avr/pgmspace.h>
 #include <avr/eeprom.h>
 
@@ -44,14 +46,88 @@
 #include "VT100.h"
 #include "Debug.h"
 #include "Dump.h"
+#include "Profile.h"
+
+#ifdef USE_PROFILE
+#include "SerialLong.h"
+#endif
 
 #define FREE_ROW    16
 
-#ifndef USE_DEBUG_ARRAY
+#define PROFILE_ROW  1
+
+#if !defined(USE_PROFILE) && !defined(USE_DEBUG_ARRAY)
 static  int StartDump =    0;
 static  int EndDump   = 0x90;
 #endif
 
+#ifdef USE_PROFILE
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintProfileHist - Print one line of ISR profile
+//
+// Min, mean and max are in CPU cycles, and the histogram bins are percent of calls.
+//
+// Inputs:      Ptr to histogram
+//
+// Outputs:     None.
+//
+static void PrintProfileHist(PROFILE_HIST *Hist) {
+    uint16_t Count = Hist->Count;
+
+    if( Count == 0 )
+        memset(Hist,0,sizeof(*Hist));
+
+    PrintD(Hist->Min,6);
+    PrintLD(Count ? Hist->Sum/Count : 0,6);
+    PrintD(Hist->Max,6);
+    PrintChar(' ');
+
+    for( uint8_t Bin=0; Bin<PROFILE_BINS; Bin++ )
+        PrintLD(Count ? Hist->Hist[Bin]*100UL/Count : 0,4);
+
+    PrintCRLF();
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintProfile - Print the ISR profile table
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void PrintProfile(void) {
+    PROFILE_STATS Stats;
+
+    if( !ProfileRunning() ) {
+        PrintStringP(PSTR("Profiler off: timer in use by PWMOut or Freq\r\n"));
+        return;
+        }
+
+    PrintStringP(PSTR("ISR          Calls       Min  Mean   Max  <32 <64<128<256<512 <1K <2K 2K+\r\n"));
+
+    for( uint8_t Id=0; Id<PROFILE_NUM_IDS; Id++ ) {
+
+        ProfileGetStats(Id,&Stats);
+
+        PrintStringP(ProfileGetName(Id));
+        for( uint8_t i=strlen_P(ProfileGetName(Id)); i<PROFILE_NAME_LEN; i++ )
+            PrintChar(' ');
+
+        PrintLD(Stats.Count,8);
+        PrintStringP(PSTR(" dur"));
+        PrintProfileHist(&Stats.Duration);
+
+        PrintStringP(PSTR("                   lat"));
+        PrintProfileHist(&Stats.Latency);
+        }
+    }
+#endif  // USE_PROFILE
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -66,7 +142,13 @@ void ShowDEScreen(void) {
     CursorHome;
     ClearScreen;
 
-#ifdef USE_DEBUG_ARRAY
+#if defined(USE_PROFILE)
+
+    //
+    // Shown by UpdateDEScreen()
+    //
+
+#elif defined(USE_DEBUG_ARRAY)
 
     PrintStringP(PSTR("DebugArray[0..0x"));
     PrintH2(DEBUG_SIZE);
@@ -104,6 +186,11 @@ void UpdateDEScreen(void) {
 
     //////////////////////////////////////////////////////////////////////////////////////
     //
+#ifdef USE_PROFILE
+    CursorPos(1,PROFILE_ROW);
+    PrintProfile();
+#endif
+
     CursorPos(1,FREE_ROW);
     DebugPrint();
 
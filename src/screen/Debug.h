@@ -94,7 +94,7 @@ extern uint16_t Debug4;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// CPUCount is used for timing
+// CPUCount is used for timing. For CPU utilization, see the load meter in Load.h
 //
 //#define DEBUG_CPU_COUNT
 
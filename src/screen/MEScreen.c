@@ -39,6 +39,7 @@
 #include "Command.h"
 #include "VT100.h"
 #include "Dump.h"
+#include "Stack.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +54,8 @@
 static  int StartDump =     0;
 static  int EndDump   = 0x100;
 
+#define STACK_ROW   19
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -93,8 +96,27 @@ void UpdateMEScreen(void) {
 
     //////////////////////////////////////////////////////////////////////////////////////
     //
-//    CursorPos(1,FREE_ROW);
-//    PrintDebug();
+    // RAM usage, from the stack monitor
+    //
+    STACK_STATS Stats;
+
+    StackGetStats(&Stats);
+
+    CursorPos(1,STACK_ROW);
+    PrintStringP(PSTR("Data "));
+    PrintD(Stats.Data,4);
+    PrintStringP(PSTR("  BSS "));
+    PrintD(Stats.BSS,4);
+    PrintStringP(PSTR("  NoInit "));
+    PrintD(Stats.NoInit,4);
+    PrintStringP(PSTR("  Stack "));
+    PrintD(Stats.Stack,4);
+    PrintStringP(PSTR("  Free "));
+    PrintD(Stats.Free,4);
+    if( Stats.Free == 0 )
+        PrintStringP(PSTR("  OVERFLOW"));
+    else
+        PrintStringP(PSTR("          "));
 
     //
     //
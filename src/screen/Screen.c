@@ -72,6 +72,12 @@
 #include "Timer.h"
 #include "Serial.h"
 
+#include "Profile.h"
+
+#ifdef USE_MEMORY_SCREEN
+#include "Stack.h"
+#endif
+
        int      SelectedScreen  NOINIT;
 static TIME_T   NextDisplayTime NOINIT;
 
@@ -96,6 +102,12 @@ void ScreenInit(void) {
     //
     NextDisplayTime = 0;
     ShowScreen('MA');
+
+#ifdef USE_MEMORY_SCREEN
+    StackInit();                    // ME screen shows the stack high-water
+#endif
+
+    ProfileInit();                  // DE screen shows the ISR profile (if USE_PROFILE)
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -196,6 +208,10 @@ void ShowScreen(int ScreenType) {
 void ScreenUpdate(void) {
     TIME_T CurrentTime = TimerGetSeconds();
 
+#ifdef USE_MEMORY_SCREEN
+    StackUpdate();                  // Keep scanning between displays
+#endif
+
     //
     // Wait until at least 1 second has elapsed before we do anything.
     //
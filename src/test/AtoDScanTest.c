@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      AtoDScanTest.c
+//
+//  SYNOPSIS
+//
+//      Auto triggered AtoD scan testing
+//
+//      #define AUTO_TRIGGER_AtoD in AtoD.h, then compile, load, and run this
+//        module.
+//
+//      Once a second the serial port shows, for each channel, the number of
+//        samples read in the last second, the min and max sample value, and
+//        the total number of samples dropped.
+//
+//      The sample count should be exactly ATOD_SAMPLE_HZ/NUM_ATOD, with no
+//        samples dropped.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+#include "AtoD.h"
+
+//
+// Timer for reports
+//
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+#ifdef AUTO_TRIGGER_AtoD
+//
+// Per-channel stats, reset at each report
+//
+static struct {
+    uint16_t    Count;
+    uint16_t    Min;
+    uint16_t    Max;
+    } Stats[NUM_ATOD];
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDScanTest - Show sample rate and range of auto triggered AtoD
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    uint16_t Samples[8];
+
+    UARTInit();
+    TimerInit();
+    AtoDInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("AtoD Scan Test\r\n");
+
+#ifndef AUTO_TRIGGER_AtoD
+    PrintString("#define AUTO_TRIGGER_AtoD in AtoD.h\r\n");
+    while(1)
+        sleep_cpu();
+#else
+    for( uint8_t Chan=0; Chan<NUM_ATOD; Chan++ )
+        Stats[Chan].Min = 0xFFFF;
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+        sleep_cpu();                    // Wait for next event
+
+        for( uint8_t Chan=0; Chan<NUM_ATOD; Chan++ ) {
+            uint8_t nSamples = AtoDGetSamples(Chan,Samples,NUMOF(Samples));
+
+            for( uint8_t i=0; i<nSamples; i++ ) {
+                if( Samples[i] < Stats[Chan].Min ) Stats[Chan].Min = Samples[i];
+                if( Samples[i] > Stats[Chan].Max ) Stats[Chan].Max = Samples[i];
+                }
+            Stats[Chan].Count += nSamples;
+            }
+
+        TimerUpdate();
+
+        if( !SendReport )
+            continue;
+
+        for( uint8_t Chan=0; Chan<NUM_ATOD; Chan++ ) {
+            PrintD(Chan,0);
+            PrintString(": ");
+            PrintD(Stats[Chan].Count,5);
+            PrintString(" samples, ");
+            PrintD(Stats[Chan].Min,4);
+            PrintString(" .. ");
+            PrintD(Stats[Chan].Max,4);
+            PrintString(", dropped ");
+            PrintD(AtoDGetDropped(Chan),0);
+            PrintCRLF();
+
+            Stats[Chan].Count = 0;
+            Stats[Chan].Min   = 0xFFFF;
+            Stats[Chan].Max   = 0;
+            }
+        SendReport = false;
+        } 
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      AtoDShareTest.c
+//
+//  SYNOPSIS
+//
+//      Shared AtoD arbitration testing
+//
+//      Runs two periodic clients and one polled client on the same ADC, and
+//        reports samples per second for each. Channel 0 (AVCC ref) should get
+//        about 1/2 of the slots, and the temperature sensor (1.1v ref) about
+//        1/50, less the settling conversions after each reference change.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "Timer.h"
+#include "AtoDShare.h"
+
+//
+// Timer for report msg
+//
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+//
+// Per-client sample counts and latest values, written by the ISR
+//
+static volatile uint16_t ChanCount;
+static volatile uint16_t ChanValue;
+static volatile uint16_t TempCount;
+static volatile uint16_t TempValue;
+
+static void ChanResult(uint16_t Sample) { ChanCount++; ChanValue = Sample; }
+static void TempResult(uint16_t Sample) { TempCount++; TempValue = Sample; }
+
+static const ATOD_CLIENT ChanClient = { ATOD_REF_AVCC | 0, ATOD_PRESCALE_128,  2, ChanResult };
+static const ATOD_CLIENT TempClient = { ATOD_REF_1V1  | 8, ATOD_PRESCALE_128, 50, TempResult };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintClient - Print one client's count and value
+//
+// Inputs:      Name of client
+//              Samples since last report
+//              Latest value
+//
+// Outputs:     None.
+//
+static void PrintClient(char *Name,uint16_t Count,uint16_t Value) {
+
+    PrintString(Name);
+    PrintD(Count,5);
+    PrintString("/sec, value ");
+    PrintD(Value,4);
+    PrintCRLF();
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// AtoDShareTest - Show shared AtoD sample rates
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    uint16_t    PolledCount = 0;
+    uint16_t    PolledValue = 0;
+
+    UARTInit();
+    TimerInit();
+    AtoDShareInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    AtoDShareAdd(&ChanClient);
+    AtoDShareAdd(&TempClient);
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("AtoDShare Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        TimerUpdate();
+
+        //
+        // Polled client, once per pass
+        //
+        PolledValue = AtoDShareRead(ATOD_REF_AVCC | 1,ATOD_PRESCALE_128);
+        PolledCount++;
+
+        if( SendReport ) {
+            uint16_t Chan, ChanV, Temp, TempV;
+
+            cli();
+            Chan  = ChanCount;  ChanCount = 0;  ChanV = ChanValue;
+            Temp  = TempCount;  TempCount = 0;  TempV = TempValue;
+            sei();
+
+            PrintClient("Chan 0: ",Chan,ChanV);
+            PrintClient("Temp  : ",Temp,TempV);
+            PrintClient("Polled: ",PolledCount,PolledValue);
+            PrintCRLF();
+
+            PolledCount = 0;
+            SendReport  = false;
+            }
+
+        sleep_cpu();                    // Wait for next interrupt
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
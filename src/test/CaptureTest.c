@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      CaptureTest.c
+//
+//  SYNOPSIS
+//
+//      Input capture timestamp testing
+//
+//      Hook up a signal generator (or a push button) to ICP1 (PortB.0).
+//
+//      Compile, load, and run this module. Each captured edge is shown on the
+//        serial port, with its polarity and the time since the previous edge
+//        in uS.
+//
+//      Once a second a line shows the number of events dropped because the
+//        FIFO was full.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+#include "Capture.h"
+
+//
+// Timer for missed events msg
+//
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// CaptureTest - Show input capture events
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    CAPTURE_T   Events[8];
+    uint32_t    PrevTime = 0;
+
+    UARTInit();
+    TimerInit();
+    CaptureInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Capture Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+        uint8_t nEvents = CaptureRead(Events,NUMOF(Events));
+
+        for( uint8_t i=0; i<nEvents; i++ ) {
+            PrintChar(Events[i].Rising ? 'R' : 'F');
+            PrintString(": ");
+            PrintLD(CAPTURE_TO_US(Events[i].Time - PrevTime),0);
+            PrintString(" uS\r\n");
+            PrevTime = Events[i].Time;
+            }
+
+        TimerUpdate();
+
+        if( SendReport ) {
+            PrintString("Missed: ");
+            PrintD(CaptureGetMissed(),0);
+            PrintCRLF();
+            SendReport = false;
+            }
+
+        if( nEvents == 0 )
+            sleep_cpu();                // Wait for next event
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
@@ -57,8 +57,9 @@
 
 #include "UART.h"
 #include "Serial.h"
+#include "SerialLong.h"
 #include "PortMacros.h"
-#include "TimerB.h"
+#include "Timer.h"
 #include "Comparator.h"
 
 #define REPORT_TIME     1               // Seconds between reports
@@ -120,12 +121,12 @@ MAIN main(void) {
     // Initialize
     //
     UARTInit();
-    ReportTimer = SECONDSB(REPORT_TIME);// Init timer
+    ReportTimer = SECONDS(REPORT_TIME); // Init timer
 
     set_sleep_mode(SLEEP_MODE_IDLE);
     sleep_enable();
 
-    TimerBInit();
+    TimerInit();
     ComparatorInit();
 
     memset(&Minute,0,sizeof(Minute));
@@ -155,24 +156,25 @@ MAIN main(void) {
     // 
     while(1) {
         sleep_cpu();                    // Wait for timer
+        TimerUpdate();                  // Calls TimerISR at each tick
         } 
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBISR - Called by the timer section once a tick
+// TimerISR - Called by the timer section once a tick
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
-void TimerBISR(void) {
+void TimerISR(void) {
 
     if( --ReportTimer > 0 )             // Time to report?
         return;                         // Nope - return
 
-    ReportTimer = SECONDSB(REPORT_TIME);// Reset report timer
+    ReportTimer = SECONDS(REPORT_TIME); // Reset report timer
 
     PrintD(Round++,0);
     PrintString(" ");
@@ -191,6 +193,19 @@ void TimerBISR(void) {
 
     PrintString("CPM: ");
     PrintD(SecTotal,5);                  // => printf "%5d"
+
+#ifdef COMPARATOR_CAPTURE
+    COMPARATOR_STATS Stats;
+
+    ComparatorGetStats(&Stats);
+    PrintString(" Period: ");
+    PrintLD(Stats.Period/(COMPARATOR_HZ/1000000UL),0);
+    PrintString(" uS (");
+    PrintLD(Stats.PeriodMin/(COMPARATOR_HZ/1000000UL),0);
+    PrintString(" - ");
+    PrintLD(Stats.PeriodMax/(COMPARATOR_HZ/1000000UL),0);
+    PrintString(")");
+#endif
     PrintCRLF();
 
 #ifdef DEBUG
@@ -217,11 +232,16 @@ void TimerBISR(void) {
 //
 // ComparatorISR - Called by the comparator section when an event happens
 //
-// Inputs:      None.
+// Inputs:      Timestamp of event        (capture mode only)
+//              TRUE if ACO rising edge   (capture mode only)
 //
 // Outputs:     None.
 //
+#ifdef COMPARATOR_CAPTURE
+void ComparatorISR(uint32_t Time,bool Rising) {
+#else
 void ComparatorISR(void) {
+#endif
 
     Minute.SecCount++;
     CLICK_ON;
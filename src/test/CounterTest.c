@@ -22,8 +22,9 @@
 //      Compile, load, and run this module. The system will report the count
 //        of pulses per second to the serial port.
 //
-//      Additionally, the program will print a message when the high-water mark
-//        is reached (currently 50), and when the timer overflows.
+//      Additionally, the program will print a message each time another 50
+//        pulses have been counted (the high-water mark), and when the 32-bit
+//        count overflows.
 //
 //  DESCRIPTION
 //
@@ -63,8 +64,9 @@
 
 #include "UART.h"
 #include "Serial.h"
+#include "SerialLong.h"
 #include "PortMacros.h"
-#include "TimerB.h"
+#include "Timer.h"
 #include "Counter.h"
 
 #define REPORT_TIME     1       // Seconds between reports
@@ -78,7 +80,7 @@ TIME_T  ReportTimer         __attribute__ ((section (".noinit")));
 //
 // Previous count reported
 //
-static  uint8_t PrevCount   __attribute__ ((section (".noinit")));
+static  uint32_t PrevCount  __attribute__ ((section (".noinit")));
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,7 +101,8 @@ MAIN main(void) {
     set_sleep_mode(SLEEP_MODE_IDLE);
     sleep_enable();
 
-    TimerBInit();
+    UARTInit();
+    TimerInit();
     CounterInit();
     CounterSetHWM(HIGH_WATER);          // Set high-water mark
     PrevCount = 0;
@@ -114,29 +117,35 @@ MAIN main(void) {
     // 
     while(1) {
         sleep_cpu();                    // Wait for timer
+        TimerUpdate();                  // Calls TimerISR at each tick
         } 
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBISR - Called by the timer section once a tick
+// TimerISR - Called by the timer section once a tick
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
-void TimerBISR(void) {
+void TimerISR(void) {
+
+    CounterUpdate();                    // Track count rate
 
     if( --ReportTimer > 0 )             // Time to report?
         return;                         // Nope - return
 
     ReportTimer = SECONDS(REPORT_TIME); // Reset report timer
 
-    uint8_t NewCount = TimerGetCount();
-    PrintD(NewCount-PrevCount,3);       // => printf "%3d"
+    uint32_t NewCount = CounterGetCount();
+    PrintLD(NewCount-PrevCount,3);      // => printf "%3ld"
     PrevCount = NewCount;
 
+    PrintString(" (last tick: ");
+    PrintLD(COUNTER_PER_SEC(CounterGetRate()),0);
+    PrintString("/sec)");
     PrintCRLF();
     }
 
@@ -145,15 +154,17 @@ void TimerBISR(void) {
 //
 // CounterHWM_ISR() - Called by the counter section at the high water mark
 //
-// Inputs:      None.
+// Inputs:      Count when called
 //
 // Outputs:     None.
 //
-void CounterHWM_ISR() {
+void CounterHWM_ISR(uint32_t Count) {
 
     PrintString("High Water: ");
-    PrintD(HIGH_WATER,3);               // => printf "%3d"
+    PrintLD(Count,0);
     PrintCRLF();
+
+    CounterSetHWM(Count+HIGH_WATER);    // Next one
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
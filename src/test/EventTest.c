@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      EventTest.c
+//
+//  SYNOPSIS
+//
+//      Event loop testing
+//
+//      #define POST_TimerEvent in Timer.h, POST_UARTEvent in UART.h, and
+//        EVENT_STATS in Event.h.
+//
+//      Compile, load, and run this module. Chars typed on the serial port are
+//        echoed back, and every 5 seconds the handler statistics are shown.
+//
+//      Typing many chars quickly should show UART handler runs with a count
+//        of more than 1.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+#include "Event.h"
+
+#define STATS_SECS      5               // Seconds between stats display
+TIME_T  StatsTimer      NOINIT;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ShowStats - Show handler statistics
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+static void ShowStats(void) {
+#ifdef EVENT_STATS
+    EVENT_STATS_T Stats;
+    uint8_t       Event;
+
+    for( Event=0; Event<NUM_EVENTS; Event++ ) {
+        EventGetStats(Event,&Stats);
+
+        if( Stats.Runs == 0 )
+            continue;
+
+        PrintString("Event ");
+        PrintD(Event,0);
+        PrintString(": Runs ");
+        PrintLD(Stats.Runs,6);
+        PrintString(" Avg us ");
+        PrintLD(Stats.Runs ? EVENT_CLOCKS_TO_US(Stats.Total/Stats.Runs) : 0,6);
+        PrintString(" Max us ");
+        PrintLD(EVENT_CLOCKS_TO_US((uint32_t) Stats.Max),6);
+        PrintCRLF();
+        }
+
+    EventClearStats();
+#else
+    PrintString("EVENT_STATS not enabled\r\n");
+#endif
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Handlers - Called from the event loop
+//
+// Inputs:      Number of posts since handler last ran
+//
+// Outputs:     None.
+//
+static void UARTHandler(uint8_t Count) {
+    char InChar;
+
+    while( (InChar = GetUARTByte()) )
+        PrintChar(InChar);
+
+    if( Count > 1 ) {
+        PrintString(" [");
+        PrintD(Count,0);
+        PrintString("]");
+        }
+    }
+
+static void TimerHandler(uint8_t Count) { TimerUpdate(); }
+
+static void StatsHandler(uint8_t Count) { ShowStats(); }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EventTest - Test the event loop
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+
+    StatsTimer = SECONDS(STATS_SECS);
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+    EventInit();
+    EventSetHandler(EVENT_UART ,UARTHandler);
+    EventSetHandler(EVENT_TIMER,TimerHandler);
+    EventSetHandler(EVENT_USER0,StatsHandler);
+
+    UARTInit();
+    TimerInit();
+
+#ifdef TICKLESS_TIMER
+    TimerSetDeadline(SECONDS(STATS_SECS));
+#endif
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Event Test\r\n");
+
+    EventLoop();                        // Never returns
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+#ifdef TICKLESS_TIMER
+    TimerSetDeadline(SECONDS(STATS_SECS));
+#else
+    if( --StatsTimer > 0 )              // Time to show stats?
+        return;                         // Nope - return
+
+    StatsTimer = SECONDS(STATS_SECS);
+#endif
+    EventPost(EVENT_USER0);             // Show stats at lower priority
+    }
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      FreqTest.c
+//
+//  SYNOPSIS
+//
+//      Frequency counter testing
+//
+//      Hook up a signal generator to T0 (PortD.4). For reciprocal mode
+//        (FREQ_RECIPROCAL in Freq.h) also hook it to ICP1 (PortB.0).
+//
+//      Compile, load, and run this module. Once a second the measured
+//        frequency is shown on the serial port. In reciprocal mode it is shown
+//        to the milli-Hz, along with the raw edge and cycle counts.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+#include "Freq.h"
+
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// FreqTest - Show measured frequency
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+
+    UARTInit();
+    TimerInit();
+    FreqInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Freq Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        TimerUpdate();
+
+        if( SendReport ) {
+#ifdef FREQ_RECIPROCAL
+            uint32_t Edges;
+            uint32_t Cycles;
+            uint32_t MilliHz = FreqGetMilliHz();
+
+            FreqGetRaw(&Edges,&Cycles);
+
+            PrintLD(MilliHz/1000,0);
+            PrintChar('.');
+            PrintLD(MilliHz%1000,103);
+            PrintString(" Hz  (");
+            PrintLD(Edges,0);
+            PrintString(" edges / ");
+            PrintLD(Cycles,0);
+            PrintString(" cycles)\r\n");
+#else
+            PrintLD(GetFreq(),0);
+            PrintString(" Hz\r\n");
+#endif
+            SendReport = false;
+            }
+
+        sleep_cpu();                    // Wait for next tick
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    FreqUpdate();
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      LoadTest.c
+//
+//  SYNOPSIS
+//
+//      CPU load meter testing
+//
+//      No hookup needed: the load is generated by busy-waiting for part of
+//        every tick.
+//
+//      Compile, load, and run this module. The busy time steps up by 4 mS per
+//        tick every second, from 0 to 36 mS of the 40 mS tick, then starts over.
+//        Once a second the expected load, the measured load, and the peak over
+//        the last LOAD_WINDOW seconds are shown on the serial port.
+//
+//      The measured load should be within a percent or two of the expected one,
+//        reading slightly high from the time taken by the report itself.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "Timer.h"
+#include "Load.h"
+
+#define WORK_STEP_MS    4               // Busy time increase per second
+#define WORK_MAX_MS     36              // Max busy time per tick
+
+uint8_t         WorkMS          NOINIT; // Busy time per tick
+
+volatile bool   DoWork;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// LoadTest - Show measured CPU load
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+
+    UARTInit();
+    TimerInit();
+    LoadInit();
+
+    WorkMS = 0;
+    DoWork = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Load Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        TimerUpdate();
+
+        if( DoWork ) {
+            for( uint8_t i=0; i<WorkMS; i++ )
+                _delay_ms(1);
+
+            DoWork = false;
+            }
+
+        if( LoadUpdate() ) {
+            PrintString("Expected: ");
+            PrintD((WorkMS*100)/(1000/TICKS_PER_SEC),3);
+            PrintString("%  Load: ");
+            PrintD(LoadGetPercent(),3);
+            PrintString("%  Peak: ");
+            PrintD(LoadGetPeak(),3);
+            PrintString("%\r\n");
+
+            WorkMS += WORK_STEP_MS;
+            if( WorkMS > WORK_MAX_MS )
+                WorkMS = 0;
+            }
+
+        LoadSleep();                    // Wait for next tick
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) { DoWork = true; }
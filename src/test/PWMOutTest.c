@@ -1,25 +1,23 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-//      Copyright (C) 2016 Peter Walsh, Milford, NH 03055
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
 //      All Rights Reserved under the MIT license as outlined below.
 //
 //  FILE
-//      TimerBTest.c
+//      PWMOutTest.c
 //
 //  SYNOPSIS
 //
-//      Connect an LED and current-limiting resistor to PORTD.7
+//      Hardware PWM output testing
 //
-//      Compile, load, and run this module. The LED should blink on/off with
-//        50% duty cycle at a frequency of 1 second.
+//      Hook up a scope or LEDs to OC1A (PortB.1), OC1B (PortB.2), OC0A
+//        (PortD.6) and OC0B (PortD.5).
 //
-//      You can easily change the output pin and frequency as shown below,
-//        to suit your needs.
-//
-//  DESCRIPTION
-//
-//      This program uses the TimerB module for timing.
+//      Compile, load, and run this module. The duty cycle of each output ramps
+//        up and down continuously: Timer1 at 20 KHz phase correct, Timer0
+//        at about 1 KHz fast PWM. The Timer1 resolution is shown on the serial
+//        port at startup.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -47,70 +45,83 @@
 
 #include <avr/sleep.h>
 #include <avr/interrupt.h>
+#include <stdbool.h>
 
 #include "PortMacros.h"
-#include "TimerB.h"
-
-#define LED_PORT    D               // Use PORTD
-#define LED_PIN     7               // LED is on pin 7
+#include "UART.h"
+#include "Serial.h"
+#include "Timer.h"
+#include "PWMOut.h"
 
-#define LED_TIME    2               // Seconds on time and off time
+#define STEP            10              // Duty change per tick, in % x 10
 
-//
-// Timer for LED flashing
-//
-TIME_T  LEDTimer  __attribute__ ((section (".noinit")));
+volatile bool   Tick;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// BlinkLED - Blink an LED connected to LED_PORT
+// PWMOutTest - Ramp hardware PWM outputs
 //
 // Inputs:      None. (Embedded program - no command line options)
 //
 // Outputs:     None. (Never returns)
 //
 MAIN main(void) {
+    uint16_t    Duty = 0;
+    int8_t      Step = STEP;
 
-    //
-    // Initialize the LED port
-    //
-    _SET_BIT( _DDR(LED_PORT),LED_PIN);  // LED is an output
-    _CLR_BIT(_PORT(LED_PORT),LED_PIN);  // Set low for now
+    UARTInit();
+    TimerInit();
 
-    LEDTimer = SECONDSB(LED_TIME);      // Init LED timer
+    uint16_t Top = PWMOutInit(1,PWMOUT_PHASE,20000);
+    PWMOutInit(0,PWMOUT_FAST,1000);
+
+    Tick = false;
 
     set_sleep_mode(SLEEP_MODE_IDLE);
     sleep_enable();
 
-    TimerBInit();
-
     sei();                              // Enable interrupts
 
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("PWMOut Test\r\n");
+    PrintString("Timer1 steps: ");
+    PrintD(Top,0);
+    PrintCRLF();
+
     //////////////////////////////////////////////////////////////////////////////////////
     //
     // All done with init,
     // 
     while(1) {
-        sleep_cpu();                    // Wait for timer
+
+        TimerUpdate();
+
+        if( Tick ) {
+            if( Duty == 0          ) Step =  STEP;
+            if( Duty == PWMOUT_MAX ) Step = -STEP;
+            Duty += Step;
+
+            PWMOutSet(PWMOUT_1A,Duty);
+            PWMOutSet(PWMOUT_1B,PWMOUT_MAX-Duty);
+            PWMOutSet(PWMOUT_0A,Duty);
+            PWMOutSet(PWMOUT_0B,PWMOUT_MAX-Duty);
+            Tick = false;
+            }
+
+        sleep_cpu();                    // Wait for next tick
         } 
     }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// TimerBISR - Called by the timer section once a tick
+// TimerISR - Called by the timer section once a tick
 //
 // Inputs:      None.
 //
 // Outputs:     None.
 //
-void TimerBISR(void) {
-
-    if( --LEDTimer > 0 )                // Time to change state?
-        return;                         // Nope - return
-
-    LEDTimer = SECONDSB(LED_TIME);      // Reset LED timer
-
-    _CHG_BIT(_PORT(LED_PORT),LED_PIN);  // Change state of LED
-    }
+void TimerISR(void) { Tick = true; }
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      PWMTest.c
+//
+//  SYNOPSIS
+//
+//      PWM measurement testing
+//
+//      Hook up a PWM signal to ICP1 (PortB.0). With PWM_PCI_CHANNELS defined
+//        in PWM.h, more PWM signals can go to the pins in PWM_PCI_MASK.
+//
+//      Compile, load, and run this module. Once a second each channel is
+//        shown on the serial port: period, high time and jitter in uS, duty
+//        cycle, and the number of cycles and lost edges.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+#include "PWM.h"
+
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PWMTest - Show PWM measurements
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    PWM_STATS   Stats;
+
+    UARTInit();
+    TimerInit();
+    PWMInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("PWM Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        TimerUpdate();
+
+        if( SendReport ) {
+            for( uint8_t Channel = 0; Channel < PWM_NUM_CHANNELS; Channel++ ) {
+                PWMGetStats(Channel,&Stats);
+
+                PrintD(Channel,0);
+                PrintString(": Period ");
+                PrintLD(PWM_TO_US(Stats.Period),0);
+                PrintString(" uS, High ");
+                PrintLD(PWM_TO_US(Stats.High),0);
+                PrintString(" uS, Duty ");
+                PrintD(Stats.Duty/10,0);
+                PrintChar('.');
+                PrintD(Stats.Duty%10,0);
+                PrintString("%, Jitter ");
+                PrintLD(PWM_TO_US(PWM_JITTER(Stats)),0);
+                PrintString(" uS, Cycles ");
+                PrintD(Stats.Cycles,0);
+                PrintString(", Missed ");
+                PrintD(Stats.Missed,0);
+                PrintCRLF();
+                }
+            SendReport = false;
+            }
+
+        sleep_cpu();                    // Wait for next tick
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    PWMUpdate();
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
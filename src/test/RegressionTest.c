@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      RegressionTest.c
+//
+//  SYNOPSIS
+//
+//      Streaming linear regression testing
+//
+//      No hookup needed: the samples are generated, a noisy line with full
+//        scale X values.
+//
+//      Compile, load, and run this module. Once a second a new sample is added,
+//        and the slope, intercept and correlation so far are shown on the serial
+//        port. With REGRESSION_WINDOW defined in Regression.h, only the last
+//        REGRESSION_WINDOW samples are used.
+//
+//      The samples follow Y = X/4 + 1000, so the slope should be close to 0.250,
+//        the intercept close to 1000, and the correlation close to 1.000.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+#include "Regression.h"
+
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// PrintQ16 - Print Q16.16 value as signed, to 3 decimals
+//
+// Inputs:      Value to print
+//
+// Outputs:     None.
+//
+static void PrintQ16(int32_t Value) {
+
+    if( Value < 0 ) {
+        PrintChar('-');
+        Value = -Value;
+        }
+
+    PrintLD(REGRESSION_TO_INT(Value),0);
+    PrintChar('.');
+    PrintD(REGRESSION_FRAC(Value),103);
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// RegressionTest - Show regression of generated samples
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    uint16_t SampleX = 0;
+    uint16_t Noise   = 0xACE1;          // LFSR state
+
+    UARTInit();
+    TimerInit();
+    RegressionStart();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Regression Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        TimerUpdate();
+
+        if( SendReport ) {
+            //
+            // Next sample: X steps across the full range, Y has +/- 64 of noise
+            //
+            Noise    = (Noise >> 1) ^ (-(Noise & 1) & 0xB400);
+            SampleX += 4999;
+
+            RegressionData(SampleX,SampleX/4 + 1000 + (Noise & 0x7F) - 64);
+
+            PrintString("N: ");
+            PrintD(GetN(),5);
+
+            if( RegressionCalc() ) {
+                PrintString("  M: ");
+                PrintQ16(GetSlope());
+                PrintString("  B: ");
+                PrintQ16(GetIntercept());
+                PrintString("  R: ");
+                PrintQ16(GetCorrelation());
+                }
+            PrintCRLF();
+
+            SendReport = false;
+            }
+
+        sleep_cpu();                    // Wait for next tick
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
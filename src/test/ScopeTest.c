@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      ScopeTest.c
+//
+//  SYNOPSIS
+//
+//      Waveform capture testing
+//
+//      Captures channel 0 on a rising crossing of mid scale, and sends each
+//        burst out the serial port once a second. Type 'h' for hex dumps (the
+//        default), 'b' for binary dumps, or 'n' to toggle between the trigger
+//        and capturing immediately.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "Timer.h"
+#include "Scope.h"
+
+#define SCOPE_CHANNEL   0
+#define SCOPE_LEVEL     128
+#define SCOPE_PRE       64
+#define SCOPE_POST      (SCOPE_SIZE-SCOPE_PRE)
+
+//
+// Timer for bursts
+//
+#define REPORT_SECS     1               // Seconds between bursts
+TIME_T  ReportTimer     NOINIT;
+
+volatile bool   SendReport;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ScopeTest - Capture and send waveforms
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    uint8_t Format  = SCOPE_HEX;
+    uint8_t Trigger = SCOPE_RISING;
+
+    UARTInit();
+    TimerInit();
+    ScopeInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Scope Test\r\n");
+
+    ScopeArm(SCOPE_CHANNEL,Trigger,SCOPE_LEVEL,SCOPE_PRE,SCOPE_POST);
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        TimerUpdate();
+
+        switch( GetUARTByte() ) {
+            case 'h': Format  = SCOPE_HEX;    break;
+            case 'b': Format  = SCOPE_BINARY; break;
+            case 'n': Trigger = Trigger == SCOPE_NOW ? SCOPE_RISING : SCOPE_NOW; break;
+            default:                          break;
+            }
+
+        if( SendReport && ScopeDone() ) {
+            ScopeDump(Format);
+            ScopeArm(SCOPE_CHANNEL,Trigger,SCOPE_LEVEL,SCOPE_PRE,SCOPE_POST);
+            SendReport = false;
+            }
+
+        sleep_cpu();                    // Wait for next interrupt
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      StackTest.c
+//
+//  SYNOPSIS
+//
+//      Stack monitor testing
+//
+//      No hookup needed: the stack use is generated by recursion.
+//
+//      Compile, load, and run this module. Every second a recursive function
+//        is called one level deeper than before, using STACK_FRAME bytes of
+//        stack per level, and the RAM usage is shown on the serial port.
+//
+//      The stack high-water should grow by about STACK_FRAME bytes every
+//        second or so (the scanner needs a few ticks to find the new mark),
+//        and the free RAM shrink by the same amount.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "Timer.h"
+#include "Stack.h"
+
+#define REPORT_SECS     1               // Seconds between reports
+TIME_T  ReportTimer     NOINIT;
+
+#define STACK_FRAME     32              // Bytes of stack used per level
+#define MAX_DEPTH       32              // Start over after this
+
+volatile bool   SendReport;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// UseStack - Use some stack, recursively
+//
+// Inputs:      Levels of recursion
+//
+// Outputs:     Sum of the frames, so the compiler can't remove them
+//
+static uint16_t __attribute__((noinline)) UseStack(uint8_t Depth) {
+    volatile uint8_t Frame[STACK_FRAME];
+
+    for( uint8_t i=0; i<STACK_FRAME; i++ )
+        Frame[i] = i;
+
+    if( Depth == 0 )
+        return Frame[1];
+
+    return Frame[Depth % STACK_FRAME] + UseStack(Depth-1);
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StackTest - Show RAM usage
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    uint8_t Depth = 0;
+
+    UARTInit();
+    TimerInit();
+    StackInit();
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = false;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+    PrintString("Stack Test\r\n");
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+
+        if( TimerUpdate() )
+            StackUpdate();
+
+        if( SendReport ) {
+            STACK_STATS Stats;
+
+            UseStack(Depth);
+
+            StackGetStats(&Stats);
+
+            PrintString("Depth: ");
+            PrintD(Depth,2);
+            PrintString("  Data: ");
+            PrintD(Stats.Data,4);
+            PrintString("  BSS: ");
+            PrintD(Stats.BSS,4);
+            PrintString("  NoInit: ");
+            PrintD(Stats.NoInit,4);
+            PrintString("  Stack: ");
+            PrintD(Stats.Stack,4);
+            PrintString("  Free: ");
+            PrintD(Stats.Free,4);
+            PrintCRLF();
+
+            if( ++Depth > MAX_DEPTH )
+                Depth = 0;
+
+            SendReport = false;
+            }
+
+        sleep_cpu();                    // Wait for next tick
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+    if( --ReportTimer > 0 )             // Time to report?
+        return;                         // Nope - return
+
+    ReportTimer = SECONDS(REPORT_SECS);
+    SendReport  = true;                 // Set flag - time for report
+    }
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      TimerTicklessTest.c
+//
+//  SYNOPSIS
+//
+//      Serial port tickless timer testing
+//
+//      Compile, load, and run this module. Once a second the serial port should
+//        show the realtime clock, and the number of timer wakeups in the
+//        previous second.
+//
+//      Run it once as-is, and again with TICKLESS_TIMER #defined in Timer.h,
+//        to compare the wakeup rate of the two modes.
+//
+//      The realtime clock should advance by exactly 1.000 each line in both
+//        modes.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+
+#include "PortMacros.h"
+#include "UART.h"
+#include "Serial.h"
+#include "SerialLong.h"
+#include "Timer.h"
+
+//
+// Timer for heartbeat msg
+//
+#define HEARTBEAT_SECS  1               // Seconds between heartbeat msg
+TIME_T  HeartbeatTimer  NOINIT;
+
+volatile bool   SendHeartbeat;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerTicklessTest - Show realtime clock and timer wakeups per second
+//
+// Inputs:      None. (Embedded program - no command line options)
+//
+// Outputs:     None. (Never returns)
+//
+MAIN main(void) {
+    uint32_t PrevWakeups = 0;
+
+    UARTInit();
+    TimerInit();
+
+    HeartbeatTimer = SECONDS(HEARTBEAT_SECS);
+    SendHeartbeat  = false;
+
+#ifdef TICKLESS_TIMER
+    TimerSetDeadline(SECONDS(HEARTBEAT_SECS));
+#endif
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+
+    sei();                              // Enable interrupts
+
+    PrintCRLF();
+    PrintCRLF();
+    PrintCRLF();
+#ifdef TICKLESS_TIMER
+    PrintString("Timer Test (tickless)\r\n");
+#else
+    PrintString("Timer Test (ticked)\r\n");
+#endif
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    //
+    // All done with init,
+    // 
+    while(1) {
+        TimerUpdate();
+
+        if( SendHeartbeat ) {
+            uint32_t Wakeups = TimerGetWakeups();
+
+            PrintLD(TimerGetSeconds(),0);
+            PrintChar('.');
+            PrintD(TimerGetMS(),103);
+            PrintString(": Wakeups/sec ");
+            PrintLD(Wakeups-PrevWakeups,0);
+            PrintCRLF();
+
+            PrevWakeups   = Wakeups;
+            SendHeartbeat = false;
+            }
+
+        sleep_cpu();                    // Wait for next event
+        } 
+    }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TimerISR - Called by the timer section once a tick (once a deadline when tickless)
+//
+// Don't send msgs directly from an ISR, set a flag that the main routine can see.
+//
+// Inputs:      None.
+//
+// Outputs:     None.
+//
+void TimerISR(void) {
+
+#ifdef TICKLESS_TIMER
+    TimerSetDeadline(SECONDS(HEARTBEAT_SECS));
+#else
+    if( --HeartbeatTimer > 0 )          // Time to change state?
+        return;                         // Nope - return
+
+    HeartbeatTimer = SECONDS(HEARTBEAT_SECS);
+#endif
+    SendHeartbeat  = true;              // Set flag - time for new heartbeat
+    }
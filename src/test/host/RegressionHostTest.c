@@ -0,0 +1,437 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//      Copyright (C) 2021 Rajstennaj Barrabas, Milford, NH 03055
+//      All Rights Reserved under the MIT license as outlined below.
+//
+//  FILE
+//      RegressionHostTest.c
+//
+//  SYNOPSIS
+//
+//      Host-side test of Regression.c against a reference implementation
+//
+//      Runs on the build machine, not the AVR. From src/test/host:
+//
+//          gcc -O2 -std=gnu99 -I../../atmega RegressionHostTest.c -o RegressionHostTest -lm
+//          ./RegressionHostTest
+//
+//          gcc -O2 -std=gnu99 -I../../atmega -DREGRESSION_WINDOW=32 RegressionHostTest.c -o RegressionHostTest -lm
+//          ./RegressionHostTest
+//
+//      The second build tests the sliding window. Exits with 0 if every check
+//        passes, and 1 (after listing the failures) otherwise.
+//
+//  DESCRIPTION
+//
+//      The same samples are given to Regression.c and to a reference, which
+//        keeps exact 128-bit sums and divides in long double. Each result must
+//        be within a couple of Q16.16 LSBs of the reference, after clipping the
+//        reference to the Q16.16 range:
+//
+//          Slope        1 LSB (truncated)
+//          Intercept    2 LSB
+//          Correlation  2 LSB
+//
+//      Cases covered
+//
+//          Exact lines, positive and negative slopes, and constant Y
+//          Random full scale data sets of many sizes, with and without a trend
+//          REGRESSION_MAX_N samples of alternating full scale extremes
+//          Add/Remove round trips, which must restore the sums exactly
+//          A sliding window by RegressionRemove(), or by REGRESSION_WINDOW
+//          Fewer than 2 samples, and all X the same
+//
+//  NOTES
+//
+//      Regression.c is #included here, so that the test can see the internal
+//        sums. The AVR port macros are skipped, since Regression.c only needs
+//        NOINIT from them.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  MIT LICENSE
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do
+//    so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//    all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define PORTMACROS_H                    // Host build: no AVR port macros
+#define NOINIT
+
+#include "Regression.c"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data declarations
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_SAMPLES     40000
+
+static uint16_t Xs[MAX_SAMPLES];        // Samples given to the reference
+static uint16_t Ys[MAX_SAMPLES];
+
+static int      Checks;
+static int      Failures;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Random - Return random 16-bit value
+//
+// A fixed LFSR rather than rand(), so that every host runs the same data.
+//
+// Inputs:      None.
+//
+// Outputs:     The value specified.
+//
+static uint16_t Random(void) {
+    static uint32_t State = 0xACE1ACE1;
+
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+
+    return State >> 8;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ToQ16 - Convert reference value to Q16.16, clipped as Regression.c does
+//
+// Inputs:      Value to convert
+//
+// Outputs:     Value * 65536, limited to the Q16.16 range
+//
+static long double ToQ16(long double Value) {
+
+    Value *= 65536.0L;
+
+    if( Value > Q16_MAX ) return Q16_MAX;
+    if( Value < Q16_MIN ) return Q16_MIN;
+    return Value;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Check - Compare Regression.c with the reference, over samples [First, First+N)
+//
+// Inputs:      Name of test case, for failures
+//              First sample
+//              Number of samples
+//
+// Outputs:     None.
+//
+static void Check(const char *Name,int First,int N) {
+    __int128 SumX = 0, SumY = 0, SumX2 = 0, SumY2 = 0, SumXY = 0;
+
+    for( int i=First; i<First+N; i++ ) {
+        SumX  += Xs[i];
+        SumY  += Ys[i];
+        SumX2 += (__int128) Xs[i]*Xs[i];
+        SumY2 += (__int128) Ys[i]*Ys[i];
+        SumXY += (__int128) Xs[i]*Ys[i];
+        }
+
+    __int128 Sxx = N*SumX2 - SumX*SumX;
+    __int128 Syy = N*SumY2 - SumY*SumY;
+    __int128 Sxy = N*SumXY - SumX*SumY;
+
+    bool Valid = RegressionCalc();
+
+    Checks++;
+
+    if( GetN() != N || Valid != (N >= 2 && Sxx != 0) ) {
+        printf("FAIL %-12s N %5d: GetN %d, Calc %d\n",Name,N,GetN(),Valid);
+        Failures++;
+        return;
+        }
+
+    if( !Valid )
+        return;
+
+    long double M = ToQ16((long double) Sxy/(long double) Sxx);
+    long double B = ToQ16(((long double) SumY*Sxx - (long double) SumX*Sxy)/((long double) N*Sxx));
+    long double R = Syy == 0 ? 0 : ToQ16((long double) Sxy/sqrtl((long double) Sxx*(long double) Syy));
+
+    long double ErrM = fabsl(GetSlope()       - M);
+    long double ErrB = fabsl(GetIntercept()   - B);
+    long double ErrR = fabsl(GetCorrelation() - R);
+
+    if( ErrM > 1 || ErrB > 2 || ErrR > 2 ) {
+        printf("FAIL %-12s N %5d: M %ld/%.1Lf B %ld/%.1Lf R %ld/%.1Lf\n",Name,N,
+               (long) GetSlope(),M,(long) GetIntercept(),B,(long) GetCorrelation(),R);
+        Failures++;
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Add - Add a sample to both Regression.c and the reference
+//
+// Inputs:      Index of sample
+//              Sample to add
+//
+// Outputs:     Return from RegressionData()
+//
+static bool Add(int i,uint16_t X,uint16_t Y) {
+
+    Xs[i] = X;
+    Ys[i] = Y;
+
+    return RegressionData(X,Y);
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Clip - Limit value to 16 bits
+//
+// Inputs:      Value
+//
+// Outputs:     Value, or nearest of 0 and 65535
+//
+static uint16_t Clip(long Value) {
+
+    if( Value < 0     ) return 0;
+    if( Value > 65535 ) return 65535;
+    return Value;
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestDegenerate - Too few samples, or no spread in X
+//
+static void TestDegenerate(void) {
+
+    RegressionStart();
+    Check("empty",0,0);
+
+    Add(0,1000,2000);
+    Check("one",0,1);
+
+    Add(1,1000,3000);
+    Add(2,1000,4000);
+    Check("same X",0,3);
+    }
+
+
+#ifndef REGRESSION_WINDOW
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestLines - Samples exactly on a line
+//
+static void TestLines(void) {
+    static const struct { int32_t Num, Den, B; } Lines[] = {
+        {  3, 1,     7 },               // Y =  3X + 7
+        {  1, 4,  1000 },               // Y =  X/4 + 1000
+        { -1, 2, 40000 },               // Y = -X/2 + 40000
+        {  0, 1, 12345 },               // Y = 12345
+        { -7, 3, 65535 },               // Y = -7X/3 + 65535
+        };
+
+    for( unsigned l=0; l<sizeof(Lines)/sizeof(Lines[0]); l++ ) {
+        RegressionStart();
+
+        for( int i=0; i<3000; i++ ) {
+            int32_t Step = (i*7) % 5000;
+
+            Add(i,Step*Lines[l].Den,Lines[l].B + Step*Lines[l].Num);
+            }
+
+        Check("line",0,3000);
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestRandom - Random full scale data sets
+//
+// Every third set is uncorrelated noise, the rest a line with noise. Some are
+//   all near full scale, to stress the sums.
+//
+static void TestRandom(void) {
+
+    for( int t=0; t<300; t++ ) {
+        int  N     = 2 + Random() % (t < 30 ? 30000 : 500);
+        long Slope = (long) (Random() % 2001) - 1000;          // -10.00 .. 10.00
+        long Base  = Random();
+
+        RegressionStart();
+
+        for( int i=0; i<N; i++ ) {
+            uint16_t X = Random();
+            uint16_t Y = Clip(Slope*X/4000 + Base + Random() % 201 - 100);
+
+            if( t % 3 == 0 ) Y = Random();
+            if( t % 5 == 0 ) { X = 65535 - Random() % 3; Y = 65535 - Random() % 3; }
+
+            Add(i,X,Y);
+            }
+
+        Check("random",0,N);
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestMaxN - REGRESSION_MAX_N samples at the extremes, the worst case for the sums
+//
+static void TestMaxN(void) {
+
+    RegressionStart();
+
+    for( int i=0; i<REGRESSION_MAX_N; i++ )
+        Add(i,i & 1 ? 65535 : 0,i & 1 ? 0 : 65535);
+
+    Check("max N",0,REGRESSION_MAX_N);
+
+    Checks++;
+    if( RegressionData(1,1) || GetN() != REGRESSION_MAX_N ) {
+        printf("FAIL max N: sample past REGRESSION_MAX_N was accepted\n");
+        Failures++;
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestRoundTrip - Adding then removing samples restores the sums exactly
+//
+static void TestRoundTrip(void) {
+
+    for( int t=0; t<50; t++ ) {
+        int Keep  = 2 + Random() % 1000;
+        int Extra = 1 + Random() % 1000;
+
+        RegressionStart();
+        for( int i=0; i<Keep; i++ )
+            Add(i,Random(),Random());
+
+        typeof(Regression) Before = Regression;
+
+        for( int i=Keep; i<Keep+Extra; i++ )
+            Add(i,Random(),Random());
+        for( int i=Keep; i<Keep+Extra; i++ )
+            RegressionRemove(Xs[i],Ys[i]);
+
+        Checks++;
+        if( Regression.N     != Before.N     ||
+            Regression.SumX  != Before.SumX  || Regression.SumY  != Before.SumY  ||
+            Regression.SumX2 != Before.SumX2 || Regression.SumY2 != Before.SumY2 ||
+            Regression.SumXY != Before.SumXY ) {
+            printf("FAIL round trip %d: sums not restored\n",t);
+            Failures++;
+            }
+
+        Check("round trip",0,Keep);
+        }
+    }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestWindow - Sliding window, by removing the oldest sample
+//
+static void TestWindow(void) {
+    const int Window = 50;
+
+    RegressionStart();
+
+    for( int i=0; i<5000; i++ ) {
+        uint16_t X = Random();
+
+        Add(i,X,Clip(X/2 + Random() % 1000));
+
+        if( i >= Window )
+            RegressionRemove(Xs[i-Window],Ys[i-Window]);
+
+        if( i >= Window && i % 97 == 0 )
+            Check("window",i-Window+1,Window);
+        }
+    }
+#else
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TestWindow - Sliding window, by REGRESSION_WINDOW
+//
+static void TestWindow(void) {
+
+    RegressionStart();
+
+    for( int i=0; i<5000; i++ ) {
+        int      First = i+1 > REGRESSION_WINDOW ? i+1-REGRESSION_WINDOW : 0;
+        uint16_t X = Random();
+
+        Add(i,X,Clip(X/2 + Random() % 1000));
+
+        if( i % 7 == 0 || i < REGRESSION_WINDOW+2 )
+            Check("window",First,i+1-First);
+        }
+    }
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// RegressionHostTest - Run all tests
+//
+// Inputs:      None.
+//
+// Outputs:     0 if all checks pass, 1 otherwise
+//
+int main(void) {
+
+    TestDegenerate();
+#ifndef REGRESSION_WINDOW
+    TestLines();
+    TestRandom();
+    TestMaxN();
+    TestRoundTrip();
+#endif
+    TestWindow();
+
+    printf("%d checks, %d failures\n",Checks,Failures);
+
+    return Failures ? 1 : 0;
+    }